@@ -0,0 +1,93 @@
+#ifndef RUBIK_ANIMATION_H
+#define RUBIK_ANIMATION_H
+
+#include <cmath>
+
+// Easing curves available for a face turn. They map the normalized time of the
+// turn t in [0, 1] to the normalized angle in [0, 1].
+enum class EASING { LINEAR, SMOOTHSTEP, EASE_IN_OUT_CUBIC, EASE_OUT_BACK };
+
+inline float applyEasing(EASING curve, float t)
+{
+    switch (curve)
+    {
+        case EASING::SMOOTHSTEP:
+            return t * t * (3.0f - 2.0f * t);
+        case EASING::EASE_IN_OUT_CUBIC:
+            return t < 0.5f ? 4.0f * t * t * t : 1.0f - std::pow(-2.0f * t + 2.0f, 3.0f) / 2.0f;
+        case EASING::EASE_OUT_BACK:
+        {
+            // overshoots a little and settles back on the target angle
+            const float c1 = 1.70158f;
+            const float c3 = c1 + 1.0f;
+            return 1.0f + c3 * std::pow(t - 1.0f, 3.0f) + c1 * std::pow(t - 1.0f, 2.0f);
+        }
+        case EASING::LINEAR:
+        default:
+            return t;
+    }
+}
+
+// Time based clock for the face turns.
+// Every frame Begin() hands it the frame time; Advance() then spends that time on
+// the active turn and Angle() tells how far the layer has rotated.
+// When a turn ends before the frame time is used up, the remaining time stays in
+// the budget so the next queued turn starts in the same frame (catch-up when
+// frames drop), up to MaxFrameTime seconds per frame.
+class TurnClock
+{
+public:
+    float TurnsPerSecond = 2.0f;
+    EASING Easing = EASING::SMOOTHSTEP;
+    float MaxFrameTime = 0.5f; // longest frame we try to catch up, avoids jumps after a stall
+
+    void Begin(float deltaTime)
+    {
+        budget = deltaTime < 0.0f ? 0.0f : (deltaTime > MaxFrameTime ? MaxFrameTime : deltaTime);
+    }
+    bool HasBudget() const
+    {
+        return budget > 0.0f;
+    }
+    float Progress() const
+    {
+        return progress;
+    }
+    // spends the frame budget on the active turn; true when the turn reached 90 degrees
+    bool Advance()
+    {
+        progress += budget * TurnsPerSecond;
+        if (progress >= 1.0f)
+        {
+            budget = (progress - 1.0f) / TurnsPerSecond;
+            progress = 0.0f;
+            return true;
+        }
+        budget = 0.0f;
+        return false;
+    }
+    // eased angle of the active turn in degrees, computed from the progress (never accumulated)
+    float Angle() const
+    {
+        return 90.0f * applyEasing(Easing, progress);
+    }
+    // drops the active turn, used when the cube jumps to another state
+    void Cancel()
+    {
+        progress = 0.0f;
+    }
+    void SpeedUp()
+    {
+        TurnsPerSecond = TurnsPerSecond * 2.0f > 64.0f ? 64.0f : TurnsPerSecond * 2.0f;
+    }
+    void SlowDown()
+    {
+        TurnsPerSecond = TurnsPerSecond / 2.0f < 0.25f ? 0.25f : TurnsPerSecond / 2.0f;
+    }
+
+private:
+    float progress = 0.0f; // normalized time of the active turn
+    float budget = 0.0f;   // seconds of this frame not spent yet
+};
+
+#endif //RUBIK_ANIMATION_H
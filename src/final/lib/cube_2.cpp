@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "cube_2.h"
+#include "distance_table.h"
+#include "log.h"
+using namespace std;
+
+namespace solver {
+	// Corner positions in the order of Rubik's corners, doubled coordinates of a 2x2x2;
+	// the last one, down-back-left, never moves
+	static const int CORNER_POSITION[8][3] = { { -1, 1, 1 }, { 1, 1, 1 }, { 1, 1, -1 }, { -1, 1, -1 },
+		{ -1, -1, 1 }, { 1, -1, 1 }, { 1, -1, -1 }, { -1, -1, -1 } };
+	static const int FIXED = 7;
+
+	// Stickers of every corner position: the one on the up or down face first, then the
+	// other two clockwise seen from outside, so a turn takes the k-th sticker of a
+	// position to the (k + twist) % 3-th of another one for the same twist
+	struct CornerStickers {
+		int sticker[8][3];
+		int normal[8][3][3];
+
+		CornerStickers() {
+			for (int s = 0; s < 24; ++s) {
+				int position[3], n[3];
+				CubeN::stickerPlace(2, s / 4, s / 2 % 2, s % 2, position, n);
+				int p = 0;
+				while (CORNER_POSITION[p][0] != position[0] || CORNER_POSITION[p][1] != position[1] ||
+					CORNER_POSITION[p][2] != position[2])
+					++p;
+				int k = n[1] != 0 ? 0 : (n[0] != 0 ? 1 : 2);
+				sticker[p][k] = s;
+				copy(n, n + 3, normal[p][k]);
+			}
+			for (int p = 0; p < 8; ++p) {
+				const int (*n)[3] = normal[p];
+				int det = n[0][0] * (n[1][1] * n[2][2] - n[1][2] * n[2][1]) -
+					n[0][1] * (n[1][0] * n[2][2] - n[1][2] * n[2][0]) +
+					n[0][2] * (n[1][0] * n[2][1] - n[1][1] * n[2][0]);
+				if (det > 0) {
+					swap(sticker[p][1], sticker[p][2]);
+					swap(normal[p][1], normal[p][2]);
+				}
+			}
+		}
+	};
+
+	static const CornerStickers& cornerStickers() {
+		static const CornerStickers corners;
+		return corners;
+	}
+
+	// Turns are numbered face * 3 + 0 quarter, 1 half, 2 inverse, faces U, R and F
+	static SliceTurn moveOf(int move) {
+		static const signed char axis[3] = { 1, 0, 2 };
+		static const signed char quarters[3] = { -1, 2, 1 };
+		return { axis[move / 3], 1, quarters[move % 3] };
+	}
+
+	static const int FACTORIAL[7] = { 1, 1, 2, 6, 24, 120, 720 };
+
+	static int permutationIndex(const int piece[7]) {
+		int index = 0;
+		for (int i = 0; i < 7; ++i) {
+			int smaller = 0;
+			for (int j = i + 1; j < 7; ++j)
+				smaller += piece[j] < piece[i];
+			index += smaller * FACTORIAL[6 - i];
+		}
+		return index;
+	}
+	static void permutationPieces(int index, int piece[7]) {
+		bool used[7] = {};
+		for (int i = 0; i < 7; ++i) {
+			int smaller = index / FACTORIAL[6 - i];
+			index %= FACTORIAL[6 - i];
+			int p = 0;
+			while (used[p] || smaller > 0)
+				smaller -= !used[p++];
+			piece[i] = p;
+			used[p] = true;
+		}
+	}
+	// twists of the first 6 positions in base 3; the seventh makes the sum a multiple of 3
+	static int twistIndex(const int twist[7]) {
+		int index = 0;
+		for (int i = 0; i < 6; ++i)
+			index = index * 3 + twist[i];
+		return index;
+	}
+	static void twistValues(int index, int twist[7]) {
+		int sum = 0;
+		for (int i = 5; i >= 0; --i) {
+			twist[i] = index % 3;
+			sum += twist[i];
+			index /= 3;
+		}
+		twist[6] = (3 - sum % 3) % 3;
+	}
+
+	struct Cube2::Tables {
+		unsigned short permutationMove[PERMUTATIONS][MOVES];
+		unsigned short twistMove[TWISTS][MOVES];
+		DistanceTable<2> distance; // distance mod 3, 3 unreached
+
+		int entry(int state) const {
+			return distance.get(state);
+		}
+		int neighbour(int state, int move) const {
+			return permutationMove[state / TWISTS][move] * TWISTS + twistMove[state % TWISTS][move];
+		}
+
+		Tables() {
+			// where each turn takes the corner of every position and how it twists it, read
+			// from a CubeN whose stickers are their own numbers
+			const CornerStickers& corners = cornerStickers();
+			int to[MOVES][7], twisted[MOVES][7];
+			for (int m = 0; m < MOVES; ++m) {
+				CubeN cube(2);
+				for (int s = 0; s < 24; ++s)
+					cube.setSticker(s / 4, s / 2 % 2, s % 2, (char)s);
+				cube.turn(moveOf(m));
+				int destination[24];
+				for (int s = 0; s < 24; ++s)
+					destination[(int)cube.getSticker(s / 4, s / 2 % 2, s % 2)] = s;
+				for (int p = 0; p < 7; ++p)
+					for (int q = 0; q < 7; ++q)
+						for (int k = 0; k < 3; ++k)
+							if (corners.sticker[q][k] == destination[corners.sticker[p][0]]) {
+								to[m][p] = q;
+								twisted[m][p] = k;
+							}
+			}
+			for (int index = 0; index < PERMUTATIONS; ++index) {
+				int piece[7], after[7];
+				permutationPieces(index, piece);
+				for (int m = 0; m < MOVES; ++m) {
+					for (int p = 0; p < 7; ++p)
+						after[to[m][p]] = piece[p];
+					permutationMove[index][m] = (unsigned short)permutationIndex(after);
+				}
+			}
+			for (int index = 0; index < TWISTS; ++index) {
+				int twist[7], after[7];
+				twistValues(index, twist);
+				for (int m = 0; m < MOVES; ++m) {
+					for (int p = 0; p < 7; ++p)
+						after[to[m][p]] = (twist[p] + twisted[m][p]) % 3;
+					twistMove[index][m] = (unsigned short)twistIndex(after);
+				}
+			}
+			search();
+		}
+
+		// Breadth first from the solved state on every core, see distance_table.h
+		void search() {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			distance.build(STATES, vector<unsigned int>(1, 0), MOVES,
+				[this](unsigned int state, int move) { return (unsigned int)neighbour(state, move); });
+			double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+			LOG_INFO("2x2x2 distance table: " << STATES << " states up to " << distance.depth() << " turns, "
+				<< milliseconds << " ms");
+		}
+	};
+
+	const Cube2::Tables& Cube2::tables() {
+		static const Tables all;
+		return all;
+	}
+	void Cube2::prepare() {
+		tables();
+	}
+	size_t Cube2::tableBytes() {
+		return tables().distance.bytes();
+	}
+
+	Solvability Cube2::state(const CubeN& cube, int& state) {
+		Solvability check;
+		const CornerStickers& corners = cornerStickers();
+		char have[8][3];
+		for (int p = 0; p < 8; ++p)
+			for (int k = 0; k < 3; ++k) {
+				int s = corners.sticker[p][k];
+				have[p][k] = cube.getSticker(s / 4, s / 2 % 2, s % 2);
+			}
+		// colour of the faces (axis, negative / positive): the fixed corner gives the negative
+		// ones, the opposite of a colour is the only one that never shares a corner with it
+		char face[3][2];
+		for (int k = 0; k < 3; ++k) {
+			const int* n = corners.normal[FIXED][k];
+			face[n[0] != 0 ? 0 : (n[1] != 0 ? 1 : 2)][0] = have[FIXED][k];
+		}
+		for (int axis = 0; axis < 3; ++axis) {
+			int found = 0;
+			for (int p = 0; p < 8; ++p)
+				for (int k = 0; k < 3; ++k) {
+					char c = have[p][k];
+					bool shares = c == face[axis][0];
+					for (int q = 0; q < 8 && !shares; ++q)
+						shares = (have[q][0] == c || have[q][1] == c || have[q][2] == c) &&
+							(have[q][0] == face[axis][0] || have[q][1] == face[axis][0] || have[q][2] == face[axis][0]);
+					if (!shares && (found == 0 || face[axis][1] != c)) {
+						face[axis][1] = c;
+						++found;
+					}
+				}
+			if (found != 1) {
+				check.code = Solvability::WRONG_CORNERS;
+				check.reason = "The colours of the faces can't be told apart";
+				return check;
+			}
+		}
+		// colours of every corner where it belongs
+		char home[8][3];
+		for (int p = 0; p < 8; ++p)
+			for (int k = 0; k < 3; ++k) {
+				const int* n = corners.normal[p][k];
+				int axis = n[0] != 0 ? 0 : (n[1] != 0 ? 1 : 2);
+				home[p][k] = face[axis][n[axis] > 0];
+			}
+		int piece[8], twist[8], sum = 0;
+		bool used[8] = {};
+		for (int p = 0; p < 8; ++p) {
+			piece[p] = -1;
+			for (int h = 0; h < 8 && piece[p] < 0; ++h)
+				for (int o = 0; o < 3; ++o)
+					if (have[p][o] == home[h][0] && have[p][(o + 1) % 3] == home[h][1] &&
+						have[p][(o + 2) % 3] == home[h][2]) {
+						piece[p] = h;
+						twist[p] = o;
+					}
+			if (piece[p] < 0 || used[piece[p]]) {
+				check.code = Solvability::UNKNOWN_PIECE;
+				check.reason = piece[p] < 0 ? "A corner has colours no corner has" : "A corner is repeated";
+				return check;
+			}
+			used[piece[p]] = true;
+			sum += twist[p];
+		}
+		if (sum % 3 != 0) {
+			check.code = Solvability::TWISTED_CORNER;
+			check.reason = "A corner is twisted";
+			return check;
+		}
+		state = permutationIndex(piece) * TWISTS + twistIndex(twist);
+		return check;
+	}
+
+	int Cube2::distance(const int& state) {
+		const Tables& t = tables();
+		int turns = 0;
+		for (int s = state; s != 0 && turns <= MAX_DISTANCE; ++turns) {
+			const int lower = (t.entry(s) + 2) % 3;
+			int m = 0;
+			while (m < MOVES && t.entry(t.neighbour(s, m)) != lower)
+				++m;
+			if (m == MOVES)
+				return -1;
+			s = t.neighbour(s, m);
+		}
+		return turns;
+	}
+
+	Solvability Cube2::solve(const CubeN& cube, vector<SliceTurn>& solution) {
+		int s = 0;
+		Solvability check = state(cube, s);
+		if (!check.solvable())
+			return check;
+		const Tables& t = tables();
+		while (s != 0) {
+			const int lower = (t.entry(s) + 2) % 3;
+			int m = 0;
+			while (m < MOVES && t.entry(t.neighbour(s, m)) != lower)
+				++m;
+			if (m == MOVES || solution.size() >= (size_t)MAX_DISTANCE) {
+				check.code = Solvability::WRONG_CORNERS;
+				check.reason = "The 2x2x2 distance table has no way down from this state";
+				return check;
+			}
+			solution.push_back(moveOf(m));
+			s = t.neighbour(s, m);
+		}
+		return check;
+	}
+
+} // namespace solver
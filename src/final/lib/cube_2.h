@@ -0,0 +1,99 @@
+/**
+  * @file cube_2.h
+  * @brief Optimal solver of the 2x2x2 by a table with the distance of every state
+  *
+  */
+#ifndef def_cube_2_h
+#define def_cube_2_h
+
+#include <string>
+#include <vector>
+#include "cube_n.h"
+using namespace std;
+
+namespace solver {
+
+    /**
+     * @class Cube2
+     * @brief The 3674160 states of a 2x2x2, with the corner down-back-left fixed, and the fewest
+     *  turns (a half turn counts one) that solve each of them
+     * \note A state is the permutation of the other 7 corners (7! = 5040) times the twists of 6 of
+     *  them (3^6 = 729), the seventh twist follows from the others. The table keeps the distance
+     *  mod 3 of every state in 2 bits, about 0.9 MB: the turns of a state change its distance by
+     *  at most one, so the turn to a state with the distance one lower is the only one whose entry
+     *  is one less mod 3, and following it solves the cube in the fewest turns (at most MAX_DISTANCE)
+     *
+     */
+    class Cube2 {
+    public:
+        static const int PERMUTATIONS = 5040;
+        static const int TWISTS = 729;
+        static const int STATES = PERMUTATIONS * TWISTS;
+        static const int MOVES = 9;
+        static const int MAX_DISTANCE = 11;
+
+        /**
+          * @brief Builds the table, once for the whole program, with a breadth first search
+          *  on every core; later calls return at once. The first solve calls it, a server
+          *  calls it at start up
+          * @return void
+          *
+          */
+        static void prepare();
+
+        /**
+          * @brief Bytes of the distance table
+          * @return size_t
+          *
+          */
+        static size_t tableBytes();
+
+        /**
+          * @brief State of a cube: permutation * TWISTS + twist, 0 is solved
+          * \note The colours of the corner down-back-left are the ones of its faces, the opposite
+          *  faces get the colours that never share a corner with them
+          * @param const CubeN& cube
+          * @param int& state
+          * @return Solvability with the reason when the stickers are no 2x2x2 that can be solved
+          * @pre cube.size() == 2
+          *
+          */
+        static Solvability state(const CubeN& cube, int& state);
+
+        /**
+          * @brief Fewest turns that solve a state
+          * @param const int& state
+          * @return int
+          *
+          */
+        static int distance(const int& state);
+
+        /**
+          * @brief It solves the cube in the fewest turns, the outer layers of U, R and F
+          * @param const CubeN& cube
+          * @param vector<SliceTurn>& solution
+          * @return Solvability
+          * @pre cube.size() == 2, solution empty, it's modified
+          *
+          */
+        static Solvability solve(const CubeN& cube, vector<SliceTurn>& solution);
+
+    private:
+        /**
+          * @struct Tables
+          * @brief Turns of the coordinates and the distances, defined in cube_2.cpp
+          *
+          */
+        struct Tables;
+
+        /**
+          * @brief The tables, built on the first call
+          * @return const Tables&
+          *
+          */
+        static const Tables& tables();
+    };
+
+} // namespace solver
+
+#endif
@@ -0,0 +1,731 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <vector>
+#include "cube_2.h"
+#include "cube_n.h"
+#include "log.h"
+using namespace std;
+
+namespace solver {
+	// Faces in the order of Rubik's centers: outward normal, then the directions of
+	// the columns and of the rows of the face seen from outside
+	static const int FACE_NORMAL[6][3] = { { 0, 1, 0 }, { 0, 0, 1 }, { 1, 0, 0 }, { 0, 0, -1 }, { -1, 0, 0 }, { 0, -1, 0 } };
+	static const int FACE_RIGHT[6][3] = { { 1, 0, 0 }, { 1, 0, 0 }, { 0, 0, -1 }, { -1, 0, 0 }, { 0, 0, 1 }, { 1, 0, 0 } };
+	static const int FACE_DOWN[6][3] = { { 0, 0, 1 }, { 0, -1, 0 }, { 0, -1, 0 }, { 0, -1, 0 }, { 0, -1, 0 }, { 0, 0, -1 } };
+	// colour of each face of a solved Rubik
+	static const char FACE_COLOUR[6] = { 'w', 'g', 'r', 'l', 'o', 'y' };
+
+	// a quarter turn counterclockwise around the axis, as RotateQuarter in layers.h
+	static void rotate(int axis, int v[3]) {
+		int a = (axis + 1) % 3, b = (axis + 2) % 3;
+		int t = v[a];
+		v[a] = -v[b];
+		v[b] = t;
+	}
+
+	// Positions are in doubled coordinates centred on the cube: the cubie of layer i
+	// along an axis is at 2 * i - (n - 1), so they are integers for even sizes too
+	struct CubeN::Geometry {
+		int n = 0;
+		// positive quarter turn of layer (axis * n + layer): the sticker at cycles[k] goes
+		// to cycles[k + 1], 4 stickers per cycle
+		vector<unsigned short> cycles[3 * MAX_SIZE];
+
+		int index(const int position[3], const int normal[3]) const {
+			int face = 0;
+			while (FACE_NORMAL[face][0] != normal[0] || FACE_NORMAL[face][1] != normal[1] ||
+				FACE_NORMAL[face][2] != normal[2])
+				++face;
+			int column = 0, row = 0;
+			for (int k = 0; k < 3; ++k) {
+				column += position[k] * FACE_RIGHT[face][k];
+				row += position[k] * FACE_DOWN[face][k];
+			}
+			return (face * n + (row + n - 1) / 2) * n + (column + n - 1) / 2;
+		}
+		void place(int sticker, int position[3], int normal[3]) const {
+			int face = sticker / (n * n), row = sticker / n % n, column = sticker % n;
+			for (int k = 0; k < 3; ++k) {
+				normal[k] = FACE_NORMAL[face][k];
+				position[k] = FACE_NORMAL[face][k] * (n - 1) + FACE_RIGHT[face][k] * (2 * column - n + 1) +
+					FACE_DOWN[face][k] * (2 * row - n + 1);
+			}
+		}
+
+		void build(int size) {
+			n = size;
+			const int stickers = 6 * n * n;
+			for (int axis = 0; axis < 3; ++axis)
+				for (int layer = 0; layer < n; ++layer) {
+					vector<int> destination(stickers, -1);
+					for (int s = 0; s < stickers; ++s) {
+						int position[3], normal[3];
+						place(s, position, normal);
+						if (position[axis] != 2 * layer - n + 1)
+							continue;
+						rotate(axis, position);
+						rotate(axis, normal);
+						destination[s] = index(position, normal);
+					}
+					vector<unsigned short>& layerCycles = cycles[axis * n + layer];
+					vector<bool> done(stickers, false);
+					for (int s = 0; s < stickers; ++s) {
+						// the center of an outer face of odd size stays where it is
+						if (destination[s] < 0 || done[s] || destination[s] == s)
+							continue;
+						for (int k = 0, t = s; k < 4; ++k, t = destination[t]) {
+							layerCycles.push_back((unsigned short)t);
+							done[t] = true;
+						}
+					}
+				}
+		}
+	};
+
+	const CubeN::Geometry& CubeN::geometry(const int& size) {
+		static const vector<Geometry> all = [] {
+			vector<Geometry> sizes(MAX_SIZE + 1);
+			for (int s = MIN_SIZE; s <= MAX_SIZE; ++s)
+				sizes[s].build(s);
+			return sizes;
+		}();
+		return all[size];
+	}
+
+	// stickers (colours or ids) after a turn of the layer with these cycles
+	template <typename T>
+	static void turnCycles(T* sticker, const vector<unsigned short>& cycles, int quarters) {
+		const unsigned short* c = cycles.data();
+		const unsigned short* end = c + cycles.size();
+		if (quarters == 1)
+			for (; c != end; c += 4) {
+				T last = sticker[c[3]];
+				sticker[c[3]] = sticker[c[2]];
+				sticker[c[2]] = sticker[c[1]];
+				sticker[c[1]] = sticker[c[0]];
+				sticker[c[0]] = last;
+			}
+		else if (quarters == -1 || quarters == 3)
+			for (; c != end; c += 4) {
+				T first = sticker[c[0]];
+				sticker[c[0]] = sticker[c[1]];
+				sticker[c[1]] = sticker[c[2]];
+				sticker[c[2]] = sticker[c[3]];
+				sticker[c[3]] = first;
+			}
+		else if (quarters == 2 || quarters == -2)
+			for (; c != end; c += 4) {
+				swap(sticker[c[0]], sticker[c[2]]);
+				swap(sticker[c[1]], sticker[c[3]]);
+			}
+	}
+
+
+	CubeN::CubeN(const int& size) {
+		n = size < MIN_SIZE ? MIN_SIZE : (size > MAX_SIZE ? MAX_SIZE : size);
+		facelet.resize(6 * n * n);
+		for (int face = 0; face < 6; ++face)
+			fill(facelet.begin() + face * n * n, facelet.begin() + (face + 1) * n * n, FACE_COLOUR[face]);
+	}
+	int CubeN::size() const {
+		return n;
+	}
+	char CubeN::getSticker(const int& face, const int& row, const int& column) const {
+		return facelet[(face * n + row) * n + column];
+	}
+	void CubeN::setSticker(const int& face, const int& row, const int& column, const char& colour) {
+		facelet[(face * n + row) * n + column] = colour;
+	}
+	void CubeN::stickerPlace(const int& size, const int& face, const int& row, const int& column, int position[3],
+		int normal[3]) {
+		geometry(size).place((face * size + row) * size + column, position, normal);
+	}
+	void CubeN::turn(const SliceTurn& move) {
+		turnCycles(&facelet[0], geometry(n).cycles[move.axis * n + move.layer], move.quarters);
+	}
+	void CubeN::turn(const vector<SliceTurn>& moves) {
+		const Geometry& g = geometry(n);
+		for (unsigned int i = 0; i < moves.size(); ++i)
+			turnCycles(&facelet[0], g.cycles[moves[i].axis * n + moves[i].layer], moves[i].quarters);
+	}
+	bool CubeN::isSolved() const {
+		for (int face = 0; face < 6; ++face)
+			for (int k = 1; k < n * n; ++k)
+				if (facelet[face * n * n + k] != facelet[face * n * n])
+					return false;
+		return true;
+	}
+	SliceTurn CubeN::outerTurn(char move, const int& size) {
+		const signed char last = (signed char)(size - 1);
+		switch (move) {
+			case 'U': return { 1, last, -1 };
+			case 'u': return { 1, last, 1 };
+			case 'D': return { 1, 0, 1 };
+			case 'd': return { 1, 0, -1 };
+			case 'F': return { 2, last, -1 };
+			case 'f': return { 2, last, 1 };
+			case 'W': case 'B': return { 2, 0, 1 };
+			case 'w': case 'b': return { 2, 0, -1 };
+			case 'R': return { 0, last, -1 };
+			case 'r': return { 0, last, 1 };
+			case 'L': return { 0, 0, 1 };
+			case 'l': return { 0, 0, -1 };
+			default: return { 0, 0, 0 };
+		}
+	}
+	void CubeN::push(const SliceTurn& move, vector<SliceTurn>& solution) {
+		turn(move);
+		if (!solution.empty() && solution.back().axis == move.axis && solution.back().layer == move.layer) {
+			int quarters = (solution.back().quarters + move.quarters + 8) % 4;
+			if (quarters == 0)
+				solution.pop_back();
+			else
+				solution.back().quarters = (signed char)(quarters == 3 ? -1 : quarters);
+			return;
+		}
+		solution.push_back(move);
+	}
+
+
+	// Reduction
+	// Turns of a size are numbered (axis * n + layer) * 3 + 0 quarter, 1 half, 2 inverse
+	static SliceTurn turnOf(int move, int n) {
+		static const signed char quarters[3] = { 1, 2, -1 };
+		return { (signed char)(move / 3 / n), (signed char)(move / 3 % n), quarters[move % 3] };
+	}
+	static int inverseOf(int move) {
+		return move % 3 == 1 ? move : move - move % 3 + 2 - move % 3;
+	}
+
+	struct CubeN::Orbit {
+		bool wings = false;
+		int count = 0;
+		vector<short> first, second; // stickers of each position, second -1 for centers
+		vector<unsigned char> image; // image[move * count + p]: where the turn takes the piece at p
+		int paritySlice = -1; // quarter turn of an inner layer that is an odd permutation of the wings
+		vector<vector<SliceTurn>> commutators; // pure 3-cycles of the orbit
+		// For every ordered triple (a * count + b) * count + c, the shortest setup found for a
+		// 3-cycle taking the piece at a to b, b to c and c to a: its first turn (via, -1 when the
+		// commutator does it alone), the triple the rest of the setup leads to (parent) and the
+		// commutator at the end of the chain (base); length is the number of setup turns, 255
+		// if the triple was not reached
+		vector<short> via, base;
+		vector<int> parent;
+		vector<unsigned char> length;
+
+		int triple(int a, int b, int c) const {
+			return (a * count + b) * count + c;
+		}
+		// setup, commutator, setup undone
+		vector<SliceTurn> cycle(int t, int n) const {
+			vector<SliceTurn> setup;
+			while (via[t] >= 0) {
+				setup.push_back(turnOf(via[t], n));
+				t = parent[t];
+			}
+			vector<SliceTurn> moves(setup);
+			moves.insert(moves.end(), commutators[base[t]].begin(), commutators[base[t]].end());
+			for (int k = (int)setup.size() - 1; k >= 0; --k) {
+				SliceTurn undo = setup[k];
+				undo.quarters = (signed char)(undo.quarters == 2 ? 2 : -undo.quarters);
+				moves.push_back(undo);
+			}
+			return moves;
+		}
+	};
+
+	// [a, b] = a b a' b'
+	static vector<SliceTurn> commutator(const vector<SliceTurn>& a, const vector<SliceTurn>& b) {
+		vector<SliceTurn> moves(a);
+		moves.insert(moves.end(), b.begin(), b.end());
+		for (int pass = 0; pass < 2; ++pass) {
+			const vector<SliceTurn>& undo = pass == 0 ? a : b;
+			for (int k = (int)undo.size() - 1; k >= 0; --k) {
+				SliceTurn move = undo[k];
+				move.quarters = (signed char)(move.quarters == 2 ? 2 : -move.quarters);
+				moves.push_back(move);
+			}
+		}
+		return moves;
+	}
+
+	const vector<CubeN::Orbit>& CubeN::orbits(const int& size) {
+		// built once per size under the lock, never modified afterwards
+		static mutex lock;
+		static vector<Orbit> built[MAX_SIZE + 1];
+		static bool ready[MAX_SIZE + 1] = {};
+		lock_guard<mutex> guard(lock);
+		vector<Orbit>& orbits = built[size];
+		if (ready[size])
+			return orbits;
+		ready[size] = true;
+
+		const int n = size;
+		const Geometry& g = geometry(n);
+		const int stickers = 6 * n * n, moves = 9 * n;
+		const bool odd = n % 2 == 1;
+		// destination[move * stickers + s]: where the turn takes sticker s
+		vector<short> destination(moves * stickers);
+		vector<short> ids(stickers);
+		for (int m = 0; m < moves; ++m) {
+			for (int s = 0; s < stickers; ++s)
+				ids[s] = (short)s;
+			SliceTurn t = turnOf(m, n);
+			turnCycles(&ids[0], g.cycles[t.axis * n + t.layer], t.quarters);
+			for (int s = 0; s < stickers; ++s)
+				destination[m * stickers + ids[s]] = (short)s;
+		}
+
+		// the orbits: closure of a seed position under every turn. Wings can't flip where they
+		// are, so the first sticker of a position always lands on the first sticker of another
+		vector<int> orbitOf(stickers, -1), positionOf(stickers, -1);
+		for (int pass = 0; pass < 2; ++pass)
+			for (int s = 0; s < stickers; ++s) {
+				int row = s / n % n, column = s % n;
+				bool rowInner = row > 0 && row < n - 1, columnInner = column > 0 && column < n - 1;
+				bool middle = odd && (row == n / 2 || column == n / 2);
+				bool center = rowInner && columnInner && !(odd && row == n / 2 && column == n / 2);
+				bool wing = rowInner != columnInner && !middle;
+				if (orbitOf[s] >= 0 || (pass == 0 ? !center : !wing))
+					continue;
+				Orbit orbit;
+				orbit.wings = pass == 1;
+				int partner = -1;
+				if (orbit.wings) {
+					int position[3], normal[3];
+					g.place(s, position, normal);
+					for (int k = 0; k < 3; ++k)
+						normal[k] = normal[k] == 0 && (position[k] == n - 1 || position[k] == 1 - n) ?
+							position[k] / (n - 1) : 0;
+					partner = g.index(position, normal);
+				}
+				const int id = (int)orbits.size();
+				orbit.first.push_back((short)s);
+				orbit.second.push_back((short)partner);
+				orbitOf[s] = id;
+				positionOf[s] = 0;
+				if (partner >= 0) {
+					orbitOf[partner] = id;
+					positionOf[partner] = 0;
+				}
+				for (int p = 0; p < (int)orbit.first.size(); ++p)
+					for (int m = 0; m < moves; ++m) {
+						int a = destination[m * stickers + orbit.first[p]];
+						if (orbitOf[a] >= 0)
+							continue;
+						int b = orbit.wings ? destination[m * stickers + orbit.second[p]] : -1;
+						orbitOf[a] = id;
+						positionOf[a] = (int)orbit.first.size();
+						if (b >= 0) {
+							orbitOf[b] = id;
+							positionOf[b] = (int)orbit.first.size();
+						}
+						orbit.first.push_back((short)a);
+						orbit.second.push_back((short)b);
+					}
+				orbit.count = (int)orbit.first.size();
+				orbit.image.resize(moves * orbit.count);
+				for (int m = 0; m < moves; ++m)
+					for (int p = 0; p < orbit.count; ++p)
+						orbit.image[m * orbit.count + p] = (unsigned char)positionOf[destination[m * stickers + orbit.first[p]]];
+				if (orbit.wings)
+					for (int m = 0; m < moves && orbit.paritySlice < 0; m += 3) {
+						SliceTurn t = turnOf(m, n);
+						if (t.layer == 0 || t.layer == n - 1)
+							continue;
+						vector<bool> seen(orbit.count, false);
+						int cycles = 0;
+						for (int p = 0; p < orbit.count; ++p)
+							for (int q = p; !seen[q]; q = orbit.image[m * orbit.count + q]) {
+								seen[q] = true;
+								cycles += q == p;
+							}
+						if ((orbit.count - cycles) % 2 == 1)
+							orbit.paritySlice = m;
+					}
+				orbits.push_back(orbit);
+			}
+
+		// commutators that cycle 3 pieces of one orbit and move nothing else: for centers
+		// [A' B A, C] with slices A and B on different axes and an outer layer C, for wings
+		// [A, B C B'] with an inner slice A and outer layers B and C
+		vector<vector<SliceTurn>> candidates;
+		for (int a = 0; a < 3; ++a)
+			for (int i = 1; i < n - 1; ++i)
+				for (int qa = -1; qa <= 1; qa += 2) {
+					vector<SliceTurn> A(1, SliceTurn{ (signed char)a, (signed char)i, (signed char)qa });
+					vector<SliceTurn> undoA(1, SliceTurn{ (signed char)a, (signed char)i, (signed char)-qa });
+					for (int c = 0; c < 3; ++c)
+						for (int side = 0; side < n; side += n - 1)
+							for (int qc = -1; qc <= 1; qc += 2) {
+								SliceTurn C = { (signed char)c, (signed char)side, (signed char)qc };
+								for (int b = 0; b < 3; ++b)
+									for (int j = 1; j < n - 1 && b != a; ++j)
+										for (int qb = -1; qb <= 1; qb += 2) {
+											vector<SliceTurn> setup(undoA);
+											setup.push_back({ (signed char)b, (signed char)j, (signed char)qb });
+											setup.push_back(A[0]);
+											candidates.push_back(commutator(setup, vector<SliceTurn>(1, C)));
+										}
+								for (int b = 0; b < 3; ++b)
+									for (int sideB = 0; sideB < n; sideB += n - 1)
+										for (int qb = -1; qb <= 2; ++qb) {
+											if (qb == 0)
+												continue;
+											vector<SliceTurn> conjugate(1, SliceTurn{ (signed char)b, (signed char)sideB, (signed char)qb });
+											conjugate.push_back(C);
+											conjugate.push_back({ (signed char)b, (signed char)sideB, (signed char)(qb == 2 ? 2 : -qb) });
+											candidates.push_back(commutator(A, conjugate));
+										}
+							}
+				}
+		for (unsigned int k = 0; k < candidates.size(); ++k) {
+			for (int s = 0; s < stickers; ++s)
+				ids[s] = (short)s;
+			for (unsigned int i = 0; i < candidates[k].size(); ++i) {
+				const SliceTurn& t = candidates[k][i];
+				turnCycles(&ids[0], g.cycles[t.axis * n + t.layer], t.quarters);
+			}
+			int orbit = -1, moved = 0, to[2][3], from = 0;
+			bool pure = true;
+			for (int s = 0; s < stickers && pure; ++s) {
+				if (ids[s] == s)
+					continue;
+				++moved;
+				pure = orbitOf[s] >= 0 && (orbit < 0 || orbitOf[s] == orbit) && moved <= 6;
+				orbit = orbitOf[s];
+				if (pure && orbits[orbit].first[positionOf[s]] == s) {
+					pure = from < 3;
+					if (pure) {
+						to[0][from] = positionOf[ids[s]];
+						to[1][from++] = positionOf[s];
+					}
+				}
+			}
+			if (!pure || from != 3 || moved != (orbits[orbit].wings ? 6 : 3))
+				continue;
+			Orbit& o = orbits[orbit];
+			// the piece at to[0][i] went to to[1][i]; seed the triple in its 3 rotations, and
+			// the one of the inverse commutator
+			int a = to[0][0], b = 0, c = 0;
+			for (int i = 0; i < 3; ++i)
+				if (to[0][i] == a)
+					b = to[1][i];
+			for (int i = 0; i < 3; ++i)
+				if (to[0][i] == b)
+					c = to[1][i];
+			if (o.via.empty()) {
+				int triples = o.count * o.count * o.count;
+				o.via.assign(triples, -1);
+				o.base.assign(triples, -1);
+				o.parent.assign(triples, -1);
+				o.length.assign(triples, 255);
+			}
+			vector<SliceTurn> inverse;
+			for (int i = (int)candidates[k].size() - 1; i >= 0; --i) {
+				SliceTurn move = candidates[k][i];
+				move.quarters = (signed char)(move.quarters == 2 ? 2 : -move.quarters);
+				inverse.push_back(move);
+			}
+			const int cycles[2][3] = { { o.triple(a, b, c), o.triple(b, c, a), o.triple(c, a, b) },
+				{ o.triple(a, c, b), o.triple(c, b, a), o.triple(b, a, c) } };
+			for (int d = 0; d < 2; ++d) {
+				if (o.length[cycles[d][0]] == 0)
+					continue;
+				o.commutators.push_back(d == 0 ? candidates[k] : inverse);
+				for (int i = 0; i < 3; ++i) {
+					o.base[cycles[d][i]] = (short)(o.commutators.size() - 1);
+					o.length[cycles[d][i]] = 0;
+				}
+			}
+		}
+
+		// setups, breadth first from the triples of the commutators: a triple reached from
+		// parent with the setup turn m is the one m takes to parent
+		for (unsigned int k = 0; k < orbits.size(); ++k) {
+			Orbit& o = orbits[k];
+			if (o.commutators.empty()) {
+				LOG_ERROR("No commutator for orbit " << k << " of the " << n << "x" << n << "x" << n);
+				continue;
+			}
+			queue<int> pending;
+			for (int t = 0; t < (int)o.length.size(); ++t)
+				if (o.length[t] == 0)
+					pending.push(t);
+			while (!pending.empty()) {
+				int t = pending.front();
+				pending.pop();
+				int a = t / (o.count * o.count), b = t / o.count % o.count, c = t % o.count;
+				for (int m = 0; m < moves; ++m) {
+					const unsigned char* undo = &o.image[inverseOf(m) * o.count];
+					int reached = o.triple(undo[a], undo[b], undo[c]);
+					if (o.length[reached] != 255)
+						continue;
+					o.via[reached] = (short)m;
+					o.parent[reached] = t;
+					o.base[reached] = o.base[t];
+					o.length[reached] = (unsigned char)(o.length[t] + 1);
+					pending.push(reached);
+				}
+			}
+		}
+		return orbits;
+	}
+
+	void CubeN::targetColours(char target[6]) const {
+		for (int face = 0; face < 6; ++face)
+			target[face] = n % 2 == 1 ? getSticker(face, n / 2, n / 2) : FACE_COLOUR[face];
+	}
+
+	Rubik CubeN::skeleton(const char target[6]) const {
+		const Geometry& g = geometry(n);
+		// faces as normals
+		const int U[3] = { 0, 1, 0 }, D[3] = { 0, -1, 0 }, F[3] = { 0, 0, 1 };
+		const int B[3] = { 0, 0, -1 }, R[3] = { 1, 0, 0 }, L[3] = { -1, 0, 0 };
+		struct EdgeSlot { int x, y, z; const int* up; const int* down; };
+		struct CornerSlot { int x, y, z; const int* up; const int* left; const int* right; };
+		// piece order and sticker roles of Rubik, as ToRubik() in logical_cube.h
+		const EdgeSlot edges[12] = {
+			{ 0, 1, 1, U, F }, { 1, 1, 0, U, R }, { 0, 1, -1, U, B }, { -1, 1, 0, U, L },
+			{ 0, -1, 1, D, F }, { 1, -1, 0, D, R }, { 0, -1, -1, D, B }, { -1, -1, 0, D, L },
+			{ 1, 0, 1, F, R }, { 1, 0, -1, B, R }, { -1, 0, -1, B, L }, { -1, 0, 1, F, L }
+		};
+		const CornerSlot corners[8] = {
+			{ -1, 1, 1, U, L, F }, { 1, 1, 1, U, F, R }, { 1, 1, -1, U, R, B }, { -1, 1, -1, U, B, L },
+			{ -1, -1, 1, D, L, F }, { 1, -1, 1, D, F, R }, { 1, -1, -1, D, R, B }, { -1, -1, -1, D, B, L }
+		};
+		// the stickers are read with the colours of the faces of Rubik
+		auto colour = [&](int x, int y, int z, const int* face) {
+			const int position[3] = { x * (n - 1), y * (n - 1), z * (n - 1) };
+			char c = facelet[g.index(position, face)];
+			for (int f = 0; f < 6; ++f)
+				if (target[f] == c)
+					return FACE_COLOUR[f];
+			return c;
+		};
+
+		Rubik rubik;
+		for (int i = 0; i < 12 && n % 2 == 1; ++i) {
+			const EdgeSlot& e = edges[i];
+			Edge piece;
+			piece.up = colour(e.x, e.y, e.z, e.up);
+			piece.down = colour(e.x, e.y, e.z, e.down);
+			rubik.setEdge(i, piece);
+		}
+		for (int i = 0; i < 8; ++i) {
+			const CornerSlot& c = corners[i];
+			Corner piece;
+			piece.up = colour(c.x, c.y, c.z, c.up);
+			piece.left = colour(c.x, c.y, c.z, c.left);
+			piece.right = colour(c.x, c.y, c.z, c.right);
+			rubik.setCorner(i, piece);
+		}
+		return rubik;
+	}
+
+	bool CubeN::solveSkeleton(vector<SliceTurn>& solution, SolveProgress& progress, const char& method,
+		const SolveBudget& budget, string& reason) {
+		// a 2x2x2 is only corners: the table of Cube2 solves it in the fewest turns
+		if (n == 2) {
+			vector<SliceTurn> moves;
+			Solvability check = Cube2::solve(*this, moves);
+			if (!check.solvable()) {
+				reason = check.reason;
+				return false;
+			}
+			for (unsigned int i = 0; i < moves.size(); ++i)
+				push(moves[i], solution);
+			return !progress.cancel;
+		}
+		char target[6];
+		targetColours(target);
+		for (int face = 0; face < 6; ++face)
+			for (int other = 0; other < face; ++other)
+				if (target[face] == target[other]) {
+					reason = "Two middle centers have the same colour";
+					return false;
+				}
+		Rubik rubik = skeleton(target);
+		Solvability check = rubik.solvability();
+		// even sizes have no middle edges: their stand-ins are solved, so corners an odd
+		// permutation away read as swapped pieces until a quarter turn
+		if (n % 2 == 0 && check.code == Solvability::SWAPPED_PIECES) {
+			push(outerTurn('U', n), solution);
+			rubik = skeleton(target);
+			check = rubik.solvability();
+		}
+		if (!check.solvable()) {
+			reason = check.reason;
+			return false;
+		}
+		// the stages of Rubik count in their own progress, cancel is checked around them
+		SolveProgress stages;
+		vector<char> moves;
+		SolveResult result = rubik.solve(moves, stages, method, budget);
+		if (!result.success) {
+			reason = result.reason;
+			return false;
+		}
+		for (unsigned int i = 0; i < moves.size(); ++i)
+			push(outerTurn(moves[i], n), solution);
+		return !progress.cancel;
+	}
+
+	void CubeN::fixWingParity(vector<SliceTurn>& solution) {
+		const vector<Orbit>& all = orbits(n);
+		const Geometry& g = geometry(n);
+		char target[6];
+		targetColours(target);
+		for (unsigned int k = 0; k < all.size(); ++k) {
+			const Orbit& o = all[k];
+			if (!o.wings || o.paritySlice < 0)
+				continue;
+			// home of the piece at every position, by its colours
+			vector<int> home(o.count, -1);
+			for (int p = 0; p < o.count; ++p)
+				for (int h = 0; h < o.count; ++h)
+					if (facelet[o.first[p]] == target[o.first[h] / (g.n * g.n)] &&
+						facelet[o.second[p]] == target[o.second[h] / (g.n * g.n)])
+						home[p] = h;
+			vector<bool> seen(o.count, false);
+			int cycles = 0;
+			bool valid = true;
+			for (int p = 0; p < o.count && valid; ++p)
+				for (int q = p; valid && !seen[q]; q = home[q]) {
+					seen[q] = true;
+					cycles += q == p;
+					valid = home[q] >= 0;
+				}
+			if (valid && (o.count - cycles) % 2 == 1)
+				push(turnOf(o.paritySlice, n), solution);
+		}
+	}
+
+	bool CubeN::solveOrbits(bool wings, vector<SliceTurn>& solution, StageStats& stats, SolveProgress& progress,
+		const SolveBudget& budget, string& reason) {
+		const vector<Orbit>& all = orbits(n);
+		chrono::steady_clock::time_point deadline = chrono::steady_clock::now() +
+			chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(budget.milliseconds));
+		char target[6];
+		targetColours(target);
+		for (unsigned int k = 0; k < all.size(); ++k) {
+			const Orbit& o = all[k];
+			if (o.wings != wings)
+				continue;
+			if (++stats.iterations > budget.iterations || progress.cancel || chrono::steady_clock::now() > deadline) {
+				reason = progress.cancel ? "Cancelled" : string("Stage ") + stats.name + " went over its budget";
+				return false;
+			}
+			if (o.commutators.empty()) {
+				reason = string("No 3-cycles for the ") + stats.name;
+				return false;
+			}
+			vector<char> want[2], have[2];
+			for (int i = 0; i < 2; ++i) {
+				const vector<short>& stickers = i == 0 ? o.first : o.second;
+				want[i].resize(o.count);
+				for (int p = 0; p < o.count && (i == 0 || wings); ++p)
+					want[i][p] = target[stickers[p] / (n * n)];
+			}
+			// every round places at least one piece, the best 3-cycle first and the shortest among them
+			for (int round = 0; ; ++round) {
+				for (int i = 0; i < 2; ++i) {
+					const vector<short>& stickers = i == 0 ? o.first : o.second;
+					have[i].resize(o.count);
+					for (int p = 0; p < o.count && (i == 0 || wings); ++p)
+						have[i][p] = facelet[stickers[p]];
+				}
+				auto fits = [&](int place, int piece) {
+					return have[0][piece] == want[0][place] && (!wings || have[1][piece] == want[1][place]);
+				};
+				int solved = 0;
+				for (int p = 0; p < o.count; ++p)
+					solved += fits(p, p);
+				if (solved == o.count)
+					break;
+				if (round > 2 * o.count) {
+					reason = string("The ") + stats.name + " can't be solved, is the cube valid?";
+					return false;
+				}
+				int best = -1, bestGain = 0;
+				for (int a = 0; a < o.count; ++a) {
+					if (fits(a, a))
+						continue;
+					for (int b = 0; b < o.count; ++b) {
+						if (b == a || fits(b, b) || !fits(b, a))
+							continue;
+						for (int c = 0; c < o.count; ++c) {
+							if (c == a || c == b)
+								continue;
+							int t = o.triple(a, b, c);
+							if (o.length[t] == 255)
+								continue;
+							int gain = 1 + fits(c, b) + fits(a, c) - fits(a, a) - fits(c, c);
+							if (gain > bestGain || (best >= 0 && gain == bestGain && o.length[t] < o.length[best])) {
+								best = t;
+								bestGain = gain;
+							}
+						}
+					}
+				}
+				if (best < 0) {
+					reason = string("No 3-cycle places a piece of the ") + stats.name;
+					return false;
+				}
+				vector<SliceTurn> moves = o.cycle(best, n);
+				for (unsigned int i = 0; i < moves.size(); ++i)
+					push(moves[i], solution);
+			}
+		}
+		return true;
+	}
+
+	SolveResult CubeN::solve(vector<SliceTurn>& solution, SolveProgress& progress, const char& method,
+		const SolveBudget& budget) {
+		SolveResult result;
+		solution.clear();
+		static const char* names[SolveProgress::STAGES] = { "corners and middle edges", "centers", "wings" };
+		// built once per size, out of the budget of the stages
+		orbits(n);
+		if (n == 2)
+			Cube2::prepare();
+		for (int i = 0; i < SolveProgress::STAGES; ++i) {
+			StageStats& stats = result.stages[i];
+			stats.name = n == 2 && i == 0 ? "corners, fewest turns" : names[i];
+			if (progress.cancel) {
+				result.reason = "Cancelled";
+				return result;
+			}
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			size_t before = solution.size();
+			bool done;
+			if (i == 0)
+				done = solveSkeleton(solution, progress, method, budget, result.reason);
+			else {
+				// a slice turn of an inner layer moves centers but no corner: before the centers
+				if (i == 1)
+					fixWingParity(solution);
+				done = solveOrbits(i == 2, solution, stats, progress, budget, result.reason);
+			}
+			stats.moves = (int)(solution.size() - before);
+			stats.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+			if (progress.cancel)
+				result.reason = "Cancelled";
+			if (!done || progress.cancel) {
+				LOG_WARN("Stage " << stats.name << " of the " << n << "x" << n << "x" << n << " failed: " << result.reason);
+				return result;
+			}
+			progress.stagesDone = i + 1;
+			result.stagesDone = i + 1;
+		}
+		result.success = isSolved();
+		if (!result.success) {
+			result.reason = "Every stage finished but the cube isn't solved";
+			LOG_WARN(result.reason);
+		}
+		return result;
+	}
+
+} // namespace solver
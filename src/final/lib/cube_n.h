@@ -0,0 +1,261 @@
+/**
+  * @file cube_n.h
+  * @brief NxNxN cube from 2x2x2 to 7x7x7: stickers, slice turns and a reduction solver
+  *
+  */
+#ifndef def_cube_n_h
+#define def_cube_n_h
+
+#include <string>
+#include <vector>
+#include "solver.h"
+using namespace std;
+
+namespace solver {
+
+    /**
+     * @struct SliceTurn
+     * @brief Turn of one layer of an NxNxN cube.
+     * \note axis 0 x (towards R), 1 y (towards U), 2 z (towards F); layer counted from the
+     *  negative side, 0 is L, D or B and size - 1 is R, U or F; quarters 1 turns a quarter
+     *  counterclockwise seen from the positive side of the axis, -1 clockwise, 2 half turn.
+     *  So R is { 0, size - 1, -1 } and L is { 0, 0, 1 }
+     *
+     */
+    struct SliceTurn {
+        signed char axis, layer, quarters;
+    };
+
+    /**
+     * @class CubeN
+     * @brief Rubik's cube of any size from MIN_SIZE to MAX_SIZE, as its 6 * size * size stickers
+     *
+     */
+    class CubeN {
+    public:
+        static const int MIN_SIZE = 2;
+        static const int MAX_SIZE = 7;
+
+        /**
+          * @brief Solved cube
+          * @param const int& size
+          * @pre MIN_SIZE <= size <= MAX_SIZE
+          *
+          */
+        explicit CubeN(const int& size = 3);
+
+        /**
+          * @brief Stickers along an edge of the cube
+          * @return int
+          *
+          */
+        int size() const;
+
+        /**
+          * @brief Colour of a sticker, with the letters of Rubik
+          * @param const int& face in the order of the centers of Rubik: top(0), frontal(1), right(2),
+          *  back(3), left(4), bottom(5)
+          * @param const int& row from the top of the face
+          * @param const int& column from the left of the face
+          * @return char
+          * \note Seen from outside; the top face has the back face above it and the bottom face
+          *  has the front face above it, the side faces have the top face above them
+          *
+          */
+        char getSticker(const int& face, const int& row, const int& column) const;
+
+        /**
+          * @brief Modifier of a sticker
+          * @param const int& face
+          * @param const int& row
+          * @param const int& column
+          * @param const char& colour
+          * @return void
+          * @see getSticker()
+          *
+          */
+        void setSticker(const int& face, const int& row, const int& column, const char& colour);
+
+        /**
+          * @brief Where a sticker is: centre of its cubie and outward normal
+          * @param const int& size
+          * @param const int& face
+          * @param const int& row
+          * @param const int& column
+          * @param int position[3] in doubled coordinates centred on the cube, the cubie of
+          *  layer i along an axis is at 2 * i - (size - 1)
+          * @param int normal[3]
+          * @return void
+          * @see getSticker()
+          *
+          */
+        static void stickerPlace(const int& size, const int& face, const int& row, const int& column,
+                                 int position[3], int normal[3]);
+
+        /**
+          * @brief Turns a layer
+          * \note Every sticker of the layer moves along a precomputed cycle of 4 positions,
+          *  an outer turn of a 7x7x7 is 40 cycles
+          * @param const SliceTurn& move
+          * @return void
+          * @pre move.layer < size(), move.quarters in { 1, 2, -1 }
+          *
+          */
+        void turn(const SliceTurn& move);
+
+        /**
+          * @brief Turns every layer of a sequence, in order
+          * @param const vector<SliceTurn>& moves
+          * @return void
+          *
+          */
+        void turn(const vector<SliceTurn>& moves);
+
+        /**
+          * @brief Check if every face has a single colour
+          * @return bool
+          *
+          */
+        bool isSolved() const;
+
+        /**
+          * @brief Turns of a Rubik solution on the outer layers of this size
+          * @param char move letter of Rubik ('W' and 'w' are B and b)
+          * @param const int& size
+          * @return SliceTurn
+          *
+          */
+        static SliceTurn outerTurn(char move, const int& size);
+
+        /**
+          * @brief It solves the cube by reduction, within a budget per stage
+          * \note Stages: the corners and middle edges as a 3x3x3 with Rubik (method), then the
+          *  centers and last the wing edges, each a chain of 3-cycles that move nothing else.
+          *  Each 3-cycle is a commutator of slice turns set up with a few more turns, looked
+          *  up in tables built once per size. The wing edges are solved where they belong, not
+          *  only paired: one slice turn before the centers fixes their parity, so the cube never
+          *  needs the parity algorithms of the classic reduction. A 2x2x2 is solved in the
+          *  fewest turns by Cube2 instead, whatever the method
+          * @param vector<SliceTurn>& solution
+          * @param SolveProgress& progress
+          * @param const char& method of the 3x3x3 stage, 'B' beginners, 'C' CFOP or 'S' fewest turns search
+          * @param const SolveBudget& budget iterations count the orbits of centers and wings
+          * @return SolveResult
+          * @pre solution empty, it's modified
+          * @see Rubik::solve()
+          *
+          */
+        SolveResult solve(vector<SliceTurn>& solution, SolveProgress& progress, const char& method = 'C',
+                          const SolveBudget& budget = SolveBudget());
+
+    private:
+        /**
+          * @brief Stickers along an edge
+          *
+          */
+        int n;
+
+        /**
+          * @brief Colours, face after face in the order of Rubik's centers, rows from the top
+          *
+          */
+        string facelet;
+
+        /**
+          * @struct Geometry
+          * @brief Where every sticker is and the cycles of every layer, defined in cube_n.cpp
+          *
+          */
+        struct Geometry;
+
+        /**
+          * @brief Geometry of a size, built once for all sizes
+          * @param const int& size
+          * @return const Geometry&
+          *
+          */
+        static const Geometry& geometry(const int& size);
+
+        /**
+          * @struct Orbit
+          * @brief Centers or wing edges that only swap places among themselves, with the
+          *  3-cycles that move them, defined in cube_n.cpp
+          *
+          */
+        struct Orbit;
+
+        /**
+          * @brief Orbits of a size with their tables, built on the first solve of that size
+          * @param const int& size
+          * @return const vector<Orbit>&
+          *
+          */
+        static const vector<Orbit>& orbits(const int& size);
+
+        /**
+          * @brief Colour every face ends with: the middle centers for odd sizes, the colours
+          *  of Rubik for even ones
+          * @param char target[6]
+          * @return void
+          *
+          */
+        void targetColours(char target[6]) const;
+
+        /**
+          * @brief The corners and middle edges as a Rubik, with the colours of the faces of Rubik
+          * @param const char target[6]
+          * @return Rubik
+          *
+          */
+        Rubik skeleton(const char target[6]) const;
+
+        /**
+          * @brief Turns a layer and appends the turn to solution, merged with the last turn
+          *  when it is the same layer
+          * @param const SliceTurn& move
+          * @param vector<SliceTurn>& solution
+          * @return void
+          *
+          */
+        void push(const SliceTurn& move, vector<SliceTurn>& solution);
+
+        /**
+          * @brief Stage 1: corners and middle edges
+          * @param vector<SliceTurn>& solution
+          * @param SolveProgress& progress
+          * @param const char& method
+          * @param const SolveBudget& budget
+          * @param string& reason why it failed
+          * @return bool
+          *
+          */
+        bool solveSkeleton(vector<SliceTurn>& solution, SolveProgress& progress, const char& method,
+                           const SolveBudget& budget, string& reason);
+
+        /**
+          * @brief Stages 2 and 3: every orbit of centers (wings false) or of wing edges (wings true)
+          * @param bool wings
+          * @param vector<SliceTurn>& solution
+          * @param StageStats& stats
+          * @param SolveProgress& progress
+          * @param const SolveBudget& budget
+          * @param string& reason why it failed
+          * @return bool
+          *
+          */
+        bool solveOrbits(bool wings, vector<SliceTurn>& solution, StageStats& stats, SolveProgress& progress,
+                         const SolveBudget& budget, string& reason);
+
+        /**
+          * @brief One slice turn for every orbit of wing edges whose pieces are an odd
+          *  permutation away from their places, which 3-cycles alone can't solve
+          * @param vector<SliceTurn>& solution
+          * @return void
+          *
+          */
+        void fixWingParity(vector<SliceTurn>& solution);
+    };
+
+} // namespace solver
+
+#endif
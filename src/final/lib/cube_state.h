@@ -0,0 +1,90 @@
+#ifndef RUBIK_CUBE_STATE_H
+#define RUBIK_CUBE_STATE_H
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "layers.h"
+#include "orientation.h"
+
+// Integer state of the cubies of an NxNxN cube: where each one is and how it
+// is rotated. Only the surface cubies are kept (26 of a 3x3x3, 218 of a 7x7x7),
+// numbered in the order of their slots; cubie i starts at the i-th surface slot
+// with the identity orientation. occupant is the inverse map (slot -> cubie, -1
+// inside the cube) so a layer can be walked without searching.
+struct CubeState
+{
+    int size = 3;
+    std::vector<glm::ivec3> position; // doubled coordinates, see layers.h
+    std::vector<int> orientation;
+    std::vector<int> occupant;
+
+    explicit CubeState(int n = 3)
+    {
+        Reset(n);
+    }
+
+    int Cubies() const
+    {
+        return (int)position.size();
+    }
+
+    void Reset(int n)
+    {
+        size = n;
+        position.clear();
+        orientation.clear();
+        occupant.assign(n * n * n, -1);
+        for (int slot = 0; slot < n * n * n; ++slot)
+        {
+            if (!SurfaceSlot(n, slot))
+                continue;
+            glm::ivec3 p;
+            SlotPosition(n, slot, p.x, p.y, p.z);
+            occupant[slot] = (int)position.size();
+            position.push_back(p);
+            orientation.push_back(0);
+        }
+    }
+
+    bool InLayer(int cubie, const LayerTurn& turn) const
+    {
+        return turn.layer == LAYER_ALL || position[cubie][turn.axis] == LayerCoordinate(size, turn.layer);
+    }
+
+    // applies a finished quarter turn; the cubies moved are written to moved (up to Cubies())
+    int ApplyTurn(const LayerTurn& turn, int* moved = nullptr)
+    {
+        const LayerTables& tables = LayerTables::Get(size);
+        const OrientationTable& orientations = OrientationTable::Get();
+        const std::vector<int>& slots = tables.slots[turn.axis][LayerIndex(turn, size)];
+        const std::vector<int>& destination = tables.destination[turn.axis][turn.direction > 0];
+        const int count = (int)slots.size();
+        // the layer is read whole before it is written back, so a slot is never overwritten early
+        int previous[6 * MAX_CUBE_SIZE * MAX_CUBE_SIZE];
+        int* before = count <= (int)(sizeof(previous) / sizeof(previous[0])) ? previous : new int[count];
+        for (int k = 0; k < count; ++k)
+        {
+            int cubie = occupant[slots[k]];
+            before[k] = cubie;
+            RotateQuarter(turn.axis, turn.direction, position[cubie].x, position[cubie].y, position[cubie].z);
+            orientation[cubie] = orientations.afterTurn[orientation[cubie]][turn.axis][turn.direction > 0];
+            if (moved)
+                moved[k] = cubie;
+        }
+        for (int k = 0; k < count; ++k)
+            occupant[destination[slots[k]]] = before[k];
+        if (before != previous)
+            delete[] before;
+        return count;
+    }
+
+    // the cubies are 1 apart: half the doubled coordinates
+    glm::mat4 Model(int cubie) const
+    {
+        return OrientationTable::Get().Model(orientation[cubie], glm::vec3(position[cubie]) * 0.5f);
+    }
+};
+
+#endif //RUBIK_CUBE_STATE_H
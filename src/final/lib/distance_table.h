@@ -0,0 +1,204 @@
+#ifndef RUBIK_DISTANCE_TABLE_H
+#define RUBIK_DISTANCE_TABLE_H
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// Distance from the start states to every state of a coordinate space (the
+// twists of the corners, the placements of the cross edges, a whole 2x2x2...),
+// found by a breadth first search on every core and packed BITS per state:
+// with 4 bits (nibbles) an entry is the distance itself, capped at 14, which is
+// still a lower bound for a search; with 2 bits it is the distance mod 3, enough
+// to walk down to a start state, as the turns of a state change its distance by
+// at most one and only the way down is one less mod 3.
+// The search goes a level at a time over bitsets of the frontier (the states of
+// the current level) and of the next level. The threads take chunks of the
+// frontier in turns, so a chunk with many states doesn't hold the others back:
+// - top down, while the frontier is small: each state of the frontier turns to
+//   its neighbours, and a neighbour still unreached gets its entry with a compare
+//   and swap on its word, so two threads reaching it together write it once;
+// - bottom up, once the frontier outgrows the states left: each unreached state
+//   looks for a neighbour in the frontier. A chunk is whole words of the table
+//   and of the next bitset, so a thread only writes its own words and the many
+//   states that would be reached again and again cost one check each.
+// Bottom up needs the inverse of every move among the moves, true for the turns
+// of a cube.
+namespace solver {
+
+    template <int BITS>
+    class DistanceTable {
+    public:
+        static const int PER_WORD = 32 / BITS;
+        static const unsigned int UNREACHED = (1u << BITS) - 1;
+        static const int MAX_STORED = BITS == 2 ? 2 : (int)UNREACHED - 1;
+
+        // entry of a state: UNREACHED, or its distance (mod 3 with 2 bits, capped at MAX_STORED with 4)
+        int get(const unsigned int& state) const
+        {
+            return (int)(words[state / PER_WORD] >> (state % PER_WORD * BITS) & UNREACHED);
+        }
+        unsigned int size() const
+        {
+            return states;
+        }
+        size_t bytes() const
+        {
+            return words.size() * sizeof(unsigned int);
+        }
+        // distance of the farthest state
+        int depth() const
+        {
+            return levels;
+        }
+
+        // neighbour(state, move) is the state a move takes state to, for moves in [0, moves);
+        // threads 0 uses every core
+        template <typename NEIGHBOUR>
+        void build(unsigned int size, const std::vector<unsigned int>& starts, int moves,
+                   NEIGHBOUR neighbour, int threads = 0)
+        {
+            static_assert(BITS == 2 || BITS == 4, "entries of 2 or 4 bits");
+            const int CHUNK = 64; // frontier words (of 64 states) a thread takes at once
+            states = size;
+            const unsigned int frontierWords = (size + 63) / 64;
+            const unsigned int tableWords = (size + PER_WORD - 1) / PER_WORD;
+            std::vector<std::atomic<unsigned int>> packed(tableWords);
+            std::vector<std::atomic<unsigned long long>> frontier(frontierWords), next(frontierWords);
+            for (unsigned int w = 0; w < tableWords; ++w)
+                packed[w].store(~0u, std::memory_order_relaxed);
+            for (unsigned int w = 0; w < frontierWords; ++w)
+                frontier[w].store(0, std::memory_order_relaxed);
+            unsigned long long reachedTotal = 0, frontierStates = 0;
+            for (unsigned int i = 0; i < starts.size(); ++i)
+                if (write(packed, starts[i], 0))
+                {
+                    frontier[starts[i] / 64].fetch_or(1ull << (starts[i] % 64), std::memory_order_relaxed);
+                    ++frontierStates;
+                }
+            reachedTotal = frontierStates;
+            if (threads <= 0)
+                threads = std::max(1, (int)std::thread::hardware_concurrency());
+
+            for (levels = 0; frontierStates > 0; ++levels)
+            {
+                for (unsigned int w = 0; w < frontierWords; ++w)
+                    next[w].store(0, std::memory_order_relaxed);
+                const unsigned int mark = entryFor(levels + 1);
+                const bool bottomUp = frontierStates > size - reachedTotal;
+                std::atomic<unsigned int> chunk{ 0 };
+                std::atomic<unsigned long long> reached{ 0 };
+                auto expand = [&]() {
+                    unsigned long long found = 0;
+                    for (unsigned int c = chunk.fetch_add(1); c * CHUNK < frontierWords; c = chunk.fetch_add(1))
+                    {
+                        const unsigned int end = std::min(frontierWords, (c + 1) * CHUNK);
+                        for (unsigned int w = c * CHUNK; w < end; ++w)
+                            found += bottomUp ? pull(packed, frontier, next, w, size, mark, moves, neighbour)
+                                              : push(packed, frontier, next, w, mark, moves, neighbour);
+                    }
+                    reached += found;
+                };
+                std::vector<std::thread> workers;
+                for (int i = 1; i < threads; ++i)
+                    workers.emplace_back(expand);
+                expand();
+                for (unsigned int i = 0; i < workers.size(); ++i)
+                    workers[i].join();
+                frontierStates = reached;
+                reachedTotal += frontierStates;
+                frontier.swap(next);
+            }
+            --levels;
+            words.resize(tableWords);
+            for (unsigned int w = 0; w < tableWords; ++w)
+                words[w] = packed[w].load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::vector<unsigned int> words;
+        unsigned int states = 0;
+        int levels = 0;
+
+        static unsigned int entryFor(int distance)
+        {
+            return BITS == 2 ? (unsigned int)(distance % 3) : (unsigned int)std::min(distance, (int)MAX_STORED);
+        }
+
+        // sets the entry of an unreached state; false if it was reached already
+        static bool write(std::vector<std::atomic<unsigned int>>& packed, unsigned int state, unsigned int value)
+        {
+            std::atomic<unsigned int>& word = packed[state / PER_WORD];
+            const int shift = state % PER_WORD * BITS;
+            unsigned int old = word.load(std::memory_order_relaxed);
+            while ((old >> shift & UNREACHED) == UNREACHED &&
+                   !word.compare_exchange_weak(old, (old & ~(UNREACHED << shift)) | value << shift,
+                                               std::memory_order_relaxed))
+            {
+            }
+            return (old >> shift & UNREACHED) == UNREACHED;
+        }
+
+        // top down: the neighbours of the frontier states of word w
+        template <typename NEIGHBOUR>
+        static unsigned long long push(std::vector<std::atomic<unsigned int>>& packed,
+                                       const std::vector<std::atomic<unsigned long long>>& frontier,
+                                       std::vector<std::atomic<unsigned long long>>& next, unsigned int w,
+                                       unsigned int mark, int moves, NEIGHBOUR& neighbour)
+        {
+            unsigned long long found = 0;
+            unsigned long long bits = frontier[w].load(std::memory_order_relaxed);
+            for (unsigned int b = 0; bits != 0; ++b, bits >>= 1)
+            {
+                if ((bits & 1) == 0)
+                    continue;
+                for (int m = 0; m < moves; ++m)
+                {
+                    const unsigned int t = neighbour(w * 64 + b, m);
+                    if (!write(packed, t, mark))
+                        continue;
+                    next[t / 64].fetch_or(1ull << (t % 64), std::memory_order_relaxed);
+                    ++found;
+                }
+            }
+            return found;
+        }
+
+        // bottom up: the unreached states of word w with a neighbour in the frontier
+        template <typename NEIGHBOUR>
+        static unsigned long long pull(std::vector<std::atomic<unsigned int>>& packed,
+                                       const std::vector<std::atomic<unsigned long long>>& frontier,
+                                       std::vector<std::atomic<unsigned long long>>& next, unsigned int w,
+                                       unsigned int size, unsigned int mark, int moves, NEIGHBOUR& neighbour)
+        {
+            unsigned long long found = 0, reached = 0;
+            for (unsigned int b = 0; b < 64; ++b)
+            {
+                const unsigned int state = w * 64 + b;
+                if (state >= size || (packed[state / PER_WORD].load(std::memory_order_relaxed) >>
+                                      (state % PER_WORD * BITS) & UNREACHED) != UNREACHED)
+                    continue;
+                for (int m = 0; m < moves; ++m)
+                {
+                    const unsigned int t = neighbour(state, m);
+                    if ((frontier[t / 64].load(std::memory_order_relaxed) >> (t % 64) & 1) == 0)
+                        continue;
+                    // the word is this thread's: a plain read and write of it is enough
+                    std::atomic<unsigned int>& word = packed[state / PER_WORD];
+                    const int shift = state % PER_WORD * BITS;
+                    word.store((word.load(std::memory_order_relaxed) & ~(UNREACHED << shift)) | mark << shift,
+                               std::memory_order_relaxed);
+                    reached |= 1ull << b;
+                    ++found;
+                    break;
+                }
+            }
+            next[w].store(reached, std::memory_order_relaxed);
+            return found;
+        }
+    };
+
+} // namespace solver
+
+#endif //RUBIK_DISTANCE_TABLE_H
@@ -0,0 +1,442 @@
+#ifndef RUBIK_FRAME_CAPTURE_H
+#define RUBIK_FRAME_CAPTURE_H
+
+#include <glad/glad.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "png_writer.h"
+
+// A frame read back from the GPU: RGBA8, rows from top to bottom.
+struct CapturedFrame
+{
+    int width = 0;
+    int height = 0;
+    long index = 0; // number of the frame since capture started
+    std::vector<unsigned char> pixels;
+};
+
+// Reads frames back through a ring of pixel buffer objects.
+// Capture() only queues glReadPixels into the next PBO and drops a fence; the
+// copy happens on the GPU while the next frames are drawn. Collect() maps the
+// PBOs whose fence has signalled, so the CPU waits only when the ring is full
+// (the GPU is more than RING frames behind).
+class FrameReadback
+{
+public:
+    static const int RING = 3;
+    using Sink = std::function<void(CapturedFrame&)>;
+
+    void Init(int width_, int height_)
+    {
+        width = width_;
+        height = height_;
+        glGenBuffers(RING, pbos);
+        for (int i = 0; i < RING; ++i)
+        {
+            glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[i]);
+            glBufferData(GL_PIXEL_PACK_BUFFER, (GLsizeiptr)width * height * 4, nullptr, GL_STREAM_READ);
+            fences[i] = nullptr;
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    }
+    void Release()
+    {
+        for (int i = 0; i < RING; ++i)
+            if (fences[i])
+                glDeleteSync(fences[i]);
+        glDeleteBuffers(RING, pbos);
+    }
+
+    // reads the bound read framebuffer (origin at the bottom left)
+    void Capture(const Sink& sink)
+    {
+        if (fences[next])
+            Read(next, sink, true); // ring full: this is the only place that waits
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[next]);
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+        glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        fences[next] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        frameIndex[next] = captured++;
+        next = (next + 1) % RING;
+    }
+
+    // hands over the frames that are ready, oldest first; with wait all pending frames
+    void Collect(const Sink& sink, bool wait = false)
+    {
+        for (int k = 0; k < RING; ++k)
+        {
+            int slot = (next + k) % RING;
+            if (fences[slot] && !Read(slot, sink, wait))
+                return; // keep the order: a later frame is never delivered before this one
+        }
+    }
+    void Flush(const Sink& sink)
+    {
+        Collect(sink, true);
+    }
+
+    long Captured() const
+    {
+        return captured;
+    }
+
+private:
+    bool Read(int slot, const Sink& sink, bool wait)
+    {
+        GLenum status = glClientWaitSync(fences[slot], wait ? GL_SYNC_FLUSH_COMMANDS_BIT : 0,
+                                         wait ? GL_TIMEOUT_IGNORED : 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            return false;
+        glDeleteSync(fences[slot]);
+        fences[slot] = nullptr;
+
+        CapturedFrame frame;
+        frame.width = width;
+        frame.height = height;
+        frame.index = frameIndex[slot];
+        frame.pixels.resize((size_t)width * height * 4);
+        const size_t row = (size_t)width * 4;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, pbos[slot]);
+        const unsigned char* data = (const unsigned char*)glMapBufferRange(
+                GL_PIXEL_PACK_BUFFER, 0, (GLsizeiptr)(row * height), GL_MAP_READ_BIT);
+        if (data)
+        {
+            for (int y = 0; y < height; ++y) // GL rows go bottom-up
+                std::memcpy(&frame.pixels[row * y], data + row * (height - 1 - y), row);
+            glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        }
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+        if (data)
+            sink(frame);
+        return true;
+    }
+
+    GLuint pbos[RING];
+    GLsync fences[RING];
+    long frameIndex[RING];
+    int next = 0;
+    long captured = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// RGB copy of an RGBA frame (the alpha of a window framebuffer means nothing)
+inline std::vector<unsigned char> DropAlpha(const CapturedFrame& frame)
+{
+    std::vector<unsigned char> rgb((size_t)frame.width * frame.height * 3);
+    for (size_t i = 0, n = (size_t)frame.width * frame.height; i < n; ++i)
+    {
+        rgb[i * 3 + 0] = frame.pixels[i * 4 + 0];
+        rgb[i * 3 + 1] = frame.pixels[i * 4 + 1];
+        rgb[i * 3 + 2] = frame.pixels[i * 4 + 2];
+    }
+    return rgb;
+}
+
+inline bool WritePng(const std::string& path, const CapturedFrame& frame)
+{
+    std::vector<unsigned char> rgb = DropAlpha(frame);
+    return png::Write(path, frame.width, frame.height, 3, rgb.data());
+}
+
+// Writes captured frames as a numbered image sequence (binary PPM or PNG) or as
+// one raw RGBA stream ("-" writes to stdout, e.g. to pipe into
+// ffmpeg -f rawvideo -pix_fmt rgba -s WxH -r FPS -i - video.mp4).
+class FrameWriter
+{
+public:
+    enum class FORMAT { PPM, PNG, RAW };
+
+    // for image sequences, path is the prefix of the files: prefix_00000.ppm, prefix_00001.ppm...
+    bool Open(FORMAT format_, const std::string& path_)
+    {
+        format = format_;
+        path = path_;
+        if (format != FORMAT::RAW)
+            return true;
+        stream = path == "-" ? stdout : std::fopen(path.c_str(), "wb");
+        return stream != nullptr;
+    }
+    std::string PathFor(long index) const
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "_%05ld.%s", index, format == FORMAT::PNG ? "png" : "ppm");
+        return path + name;
+    }
+    bool Write(const CapturedFrame& frame)
+    {
+        if (format == FORMAT::RAW)
+            return stream && std::fwrite(frame.pixels.data(), 1, frame.pixels.size(), stream) == frame.pixels.size();
+        if (format == FORMAT::PNG)
+            return WritePng(PathFor(frame.index), frame);
+
+        FILE* file = std::fopen(PathFor(frame.index).c_str(), "wb");
+        if (!file)
+            return false;
+        std::fprintf(file, "P6\n%d %d\n255\n", frame.width, frame.height);
+        std::vector<unsigned char> rgb((size_t)frame.width * 3);
+        bool ok = true;
+        for (int y = 0; y < frame.height && ok; ++y)
+        {
+            const unsigned char* src = &frame.pixels[(size_t)y * frame.width * 4];
+            for (int x = 0; x < frame.width; ++x)
+            {
+                rgb[x * 3 + 0] = src[x * 4 + 0];
+                rgb[x * 3 + 1] = src[x * 4 + 1];
+                rgb[x * 3 + 2] = src[x * 4 + 2];
+            }
+            ok = std::fwrite(rgb.data(), 1, rgb.size(), file) == rgb.size();
+        }
+        std::fclose(file);
+        return ok;
+    }
+    void Close()
+    {
+        if (stream && stream != stdout)
+            std::fclose(stream);
+        else if (stream)
+            std::fflush(stream);
+        stream = nullptr;
+    }
+
+private:
+    FORMAT format = FORMAT::PPM;
+    std::string path;
+    FILE* stream = nullptr;
+};
+
+// Compresses and writes PNG frames on worker threads, so the render loop only
+// pays for copying the frame out of its PBO. A 1080p frame takes a worker in
+// the order of 0.2 s, so up to MAX_WORKERS frames are encoded at once (each
+// one is its own file, the order doesn't matter). The queue is bounded: when
+// the encoder is MAX_QUEUE frames behind, Push() drops the frame (a live recording
+// keeps its frame rate) unless wait is set (offline rendering, where every
+// frame matters and the producer can slow down).
+class FrameEncoder
+{
+public:
+    static const size_t MAX_QUEUE = 8;
+    static const unsigned MAX_WORKERS = 4;
+
+    ~FrameEncoder()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_all();
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+
+    // takes the pixels of frame; false if it was dropped
+    bool Push(CapturedFrame& frame, const std::string& path, bool wait = false)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (workers.empty())
+        {
+            unsigned cores = std::thread::hardware_concurrency();
+            unsigned count = cores > 2 ? cores - 1 : 1; // one core stays for the render loop
+            for (unsigned i = 0; i < count && i < MAX_WORKERS; ++i)
+                workers.emplace_back([this]() { Run(); });
+        }
+        if (queue.size() >= MAX_QUEUE)
+        {
+            if (!wait)
+            {
+                ++dropped;
+                return false;
+            }
+            idle.wait(lock, [this]() { return queue.size() < MAX_QUEUE; });
+        }
+        queue.emplace_back();
+        queue.back().frame.width = frame.width;
+        queue.back().frame.height = frame.height;
+        queue.back().frame.index = frame.index;
+        queue.back().frame.pixels.swap(frame.pixels);
+        queue.back().path = path;
+        lock.unlock();
+        wake.notify_one();
+        return true;
+    }
+
+    // blocks until every queued frame is on disk
+    void Drain()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [this]() { return queue.empty() && busy == 0; });
+    }
+
+    long Dropped() const
+    {
+        return dropped;
+    }
+    long Failed() const
+    {
+        return failed;
+    }
+
+private:
+    struct Job
+    {
+        CapturedFrame frame;
+        std::string path;
+    };
+
+    void Run()
+    {
+        for (;;)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return !queue.empty() || stop; });
+                if (queue.empty())
+                    return;
+                job = std::move(queue.front());
+                queue.pop_front();
+                ++busy;
+            }
+            idle.notify_all();
+            if (!WritePng(job.path, job.frame))
+                ++failed;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --busy;
+            }
+            idle.notify_all();
+        }
+    }
+
+    std::deque<Job> queue;
+    std::mutex mutex;
+    std::condition_variable wake; // work for the encoder
+    std::condition_variable idle; // room in the queue or queue drained
+    bool stop = false;
+    int busy = 0; // frames being encoded
+    std::atomic<long> dropped{ 0 };
+    std::atomic<long> failed{ 0 };
+    std::vector<std::thread> workers;
+};
+
+// Screenshots and recordings of the window: reads the frame back through a
+// FrameReadback and hands it to a FrameEncoder. Frame() costs nothing while
+// there is nothing to capture.
+class FrameRecorder
+{
+public:
+    void Screenshot(const std::string& path)
+    {
+        screenshot = path;
+    }
+    // frames go to prefix_00000.png, prefix_00001.png...
+    void StartRecording(const std::string& prefix)
+    {
+        recordingPrefix = prefix;
+        recorded = 0;
+        recording = true;
+    }
+    void StopRecording()
+    {
+        recording = false;
+    }
+    bool Recording() const
+    {
+        return recording;
+    }
+    const FrameEncoder& Encoder() const
+    {
+        return encoder;
+    }
+
+    // call after drawing and before swapping, with the framebuffer to capture bound for reading
+    void Frame(int width, int height)
+    {
+        bool wanted = recording || !screenshot.empty();
+        if (!wanted && destinations.empty())
+            return;
+        FrameReadback::Sink deliver = [this](CapturedFrame& frame) { Deliver(frame); };
+        if (width != readbackWidth || height != readbackHeight)
+        {
+            Release();
+            readback.Init(width, height);
+            readbackWidth = width;
+            readbackHeight = height;
+        }
+        if (wanted)
+        {
+            Destination destination;
+            if (recording)
+            {
+                char name[32];
+                std::snprintf(name, sizeof(name), "_%05ld.png", recorded++);
+                destination.recording = recordingPrefix + name;
+            }
+            destination.screenshot.swap(screenshot);
+            destinations.push_back(destination);
+            readback.Capture(deliver);
+        }
+        readback.Collect(deliver);
+    }
+
+    // delivers the frames still in flight and waits for the encoder
+    void Shutdown()
+    {
+        Release();
+        encoder.Drain();
+    }
+
+private:
+    void Release()
+    {
+        if (readbackWidth == 0)
+            return;
+        readback.Flush([this](CapturedFrame& frame) { Deliver(frame); });
+        readback.Release();
+        readbackWidth = readbackHeight = 0;
+    }
+    // a recorded frame may be dropped when the encoder falls behind, a screenshot never
+    void Deliver(CapturedFrame& frame)
+    {
+        Destination destination = destinations.front();
+        destinations.pop_front();
+        if (!destination.recording.empty() && !destination.screenshot.empty())
+        {
+            CapturedFrame copy = frame;
+            encoder.Push(copy, destination.recording);
+        }
+        else if (!destination.recording.empty())
+            encoder.Push(frame, destination.recording);
+        if (!destination.screenshot.empty())
+            encoder.Push(frame, destination.screenshot, true);
+    }
+
+    struct Destination
+    {
+        std::string recording;
+        std::string screenshot;
+    };
+
+    FrameReadback readback;
+    FrameEncoder encoder;
+    std::deque<Destination> destinations; // one per frame in flight
+    std::string screenshot;
+    std::string recordingPrefix;
+    long recorded = 0;
+    bool recording = false;
+    int readbackWidth = 0;
+    int readbackHeight = 0;
+};
+
+#endif //RUBIK_FRAME_CAPTURE_H
@@ -0,0 +1,48 @@
+#ifndef RUBIK_FRUSTUM_H
+#define RUBIK_FRUSTUM_H
+
+#include <cmath>
+
+#include <glm/glm.hpp>
+
+// The six planes of a view frustum, taken straight from projection * view
+// (Gribb/Hartmann), pointing inwards. A sphere is outside when its centre is
+// further than its radius behind any plane; the test is conservative near the
+// corners (a sphere there may be kept although it is not visible), never the
+// other way around.
+class Frustum
+{
+public:
+    explicit Frustum(const glm::mat4& projectionView)
+    {
+        const glm::mat4& m = projectionView;
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int k = 0; k < 4; ++k)
+            {
+                planes[i * 2][k] = m[k][3] + m[k][i];     // left, bottom, near
+                planes[i * 2 + 1][k] = m[k][3] - m[k][i]; // right, top, far
+            }
+        }
+        for (int p = 0; p < 6; ++p)
+        {
+            float length = std::sqrt(planes[p][0] * planes[p][0] + planes[p][1] * planes[p][1]
+                                     + planes[p][2] * planes[p][2]);
+            for (int k = 0; k < 4; ++k)
+                planes[p][k] /= length;
+        }
+    }
+
+    bool SphereVisible(const glm::vec3& center, float radius) const
+    {
+        for (int p = 0; p < 6; ++p)
+            if (planes[p][0] * center[0] + planes[p][1] * center[1] + planes[p][2] * center[2] + planes[p][3] < -radius)
+                return false;
+        return true;
+    }
+
+private:
+    float planes[6][4]; // a x + b y + c z + d >= 0 inside
+};
+
+#endif //RUBIK_FRUSTUM_H
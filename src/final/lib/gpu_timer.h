@@ -0,0 +1,83 @@
+#ifndef RUBIK_GPU_TIMER_H
+#define RUBIK_GPU_TIMER_H
+
+#include <glad/glad.h>
+
+#include "profiler.h"
+
+// GPU time of a block of draw calls with GL_TIME_ELAPSED queries (core in 3.3).
+// Results arrive a few frames late, so a small ring of queries is kept in
+// flight and only results already available are read: the CPU never waits
+// for the GPU. If every query is still pending the frame is simply not timed.
+// Only one GpuTimer may be inside Begin()/End() at a time (GL allows a single
+// active GL_TIME_ELAPSED query).
+class GpuTimer
+{
+public:
+    static const int LATENCY = 4; // frames a result may take to come back
+
+    void Init(Profiler& profiler_, const char* name)
+    {
+        profiler = &profiler_;
+        section = profiler_.Section(name);
+        glGenQueries(LATENCY, queries);
+        for (int i = 0; i < LATENCY; ++i)
+            pending[i] = false;
+    }
+    void Release()
+    {
+        if (profiler)
+            glDeleteQueries(LATENCY, queries);
+        profiler = nullptr;
+    }
+
+    void Begin()
+    {
+        Collect();
+        active = profiler && !pending[next];
+        if (!active)
+            return;
+        issuedAt[next] = profiler->Now();
+        glBeginQuery(GL_TIME_ELAPSED, queries[next]);
+    }
+    void End()
+    {
+        if (!active)
+            return;
+        glEndQuery(GL_TIME_ELAPSED);
+        pending[next] = true;
+        next = (next + 1) % LATENCY;
+        active = false;
+    }
+
+    // moves the finished results into the profiler (trace lane 2)
+    void Collect()
+    {
+        if (!profiler)
+            return;
+        for (int i = 0; i < LATENCY; ++i)
+        {
+            if (!pending[i])
+                continue;
+            GLint available = 0;
+            glGetQueryObjectiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                continue;
+            GLuint64 nanoseconds = 0;
+            glGetQueryObjectui64v(queries[i], GL_QUERY_RESULT, &nanoseconds);
+            profiler->Record(section, issuedAt[i], nanoseconds * 1e-9, 2);
+            pending[i] = false;
+        }
+    }
+
+private:
+    Profiler* profiler = nullptr;
+    int section = 0;
+    GLuint queries[LATENCY];
+    double issuedAt[LATENCY];
+    bool pending[LATENCY];
+    int next = 0;
+    bool active = false;
+};
+
+#endif //RUBIK_GPU_TIMER_H
@@ -0,0 +1,138 @@
+#ifndef RUBIK_LAYERS_H
+#define RUBIK_LAYERS_H
+
+#include <vector>
+
+// Index tables for the layer rotations of an NxNxN cube, N from 2 to 7.
+// Positions are doubled coordinates centred on the cube: along each axis the
+// cubies of layer i (0 to N - 1) are at 2 * i - (N - 1), integers for even sizes
+// too, and a quarter turn is an integer rotation around the origin.
+// A slot is one of the N^3 grid positions, numbered like the cubes of CuboCompleto:
+// slot = (N - 1 - yi) * N * N + zi * N + xi with the layer indices xi, yi, zi.
+// A turn is described by (axis, layer, direction): axis 0 = x, 1 = y, 2 = z,
+// layer the index 0 to N - 1 along that axis (or LAYER_ALL for a whole cube
+// rotation) and direction the sign of the quarter turn angle around the positive axis.
+
+const int LAYER_ALL = -1;
+const int MAX_CUBE_SIZE = 7;
+
+struct LayerTurn
+{
+    int axis;
+    int layer;
+    int direction;
+    char move; // letter of the move for solver::Rubik, '\0' when the solver has no such move
+};
+
+// doubled coordinate of a layer index and back
+inline int LayerCoordinate(int size, int layer)
+{
+    return 2 * layer - (size - 1);
+}
+
+inline int LayerOf(int size, int coordinate)
+{
+    return (coordinate + size - 1) / 2;
+}
+
+inline int SlotIndex(int size, int x, int y, int z)
+{
+    return ((size - 1 - LayerOf(size, y)) * size + LayerOf(size, z)) * size + LayerOf(size, x);
+}
+
+inline void SlotPosition(int size, int slot, int& x, int& y, int& z)
+{
+    x = LayerCoordinate(size, slot % size);
+    z = LayerCoordinate(size, (slot / size) % size);
+    y = LayerCoordinate(size, size - 1 - slot / (size * size));
+}
+
+// only the cubies with a face outside are kept; the ones inside never show
+inline bool SurfaceSlot(int size, int slot)
+{
+    int p[3];
+    SlotPosition(size, slot, p[0], p[1], p[2]);
+    for (int k = 0; k < 3; ++k)
+        if (p[k] == size - 1 || p[k] == 1 - size)
+            return true;
+    return false;
+}
+
+// rotates the integer point (x, y, z) a quarter turn around the axis
+inline void RotateQuarter(int axis, int direction, int& x, int& y, int& z)
+{
+    int a, b;
+    switch (axis)
+    {
+        case 0: // (y, z) -> (-z, y)
+            a = y; b = z;
+            y = direction > 0 ? -b : b;
+            z = direction > 0 ? a : -a;
+            break;
+        case 1: // (z, x) -> (-x, z)
+            a = z; b = x;
+            z = direction > 0 ? -b : b;
+            x = direction > 0 ? a : -a;
+            break;
+        default: // (x, y) -> (-y, x)
+            a = x; b = y;
+            x = direction > 0 ? -b : b;
+            y = direction > 0 ? a : -a;
+            break;
+    }
+}
+
+struct LayerTables
+{
+    int size = 0;
+    // slots[axis][layer] lists the surface slots of a layer, slots[axis][size] all of them
+    std::vector<int> slots[3][MAX_CUBE_SIZE + 1];
+    // destination[axis][direction > 0][slot] is where a quarter turn moves the slot
+    std::vector<int> destination[3][2];
+
+    // tables of every size, built together on the first call
+    static const LayerTables& Get(int size)
+    {
+        static const std::vector<LayerTables> tables = [] {
+            std::vector<LayerTables> sizes(MAX_CUBE_SIZE + 1);
+            for (int s = 1; s <= MAX_CUBE_SIZE; ++s)
+                sizes[s].Build(s);
+            return sizes;
+        }();
+        return tables[size];
+    }
+
+private:
+    void Build(int n)
+    {
+        size = n;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            for (int dir = 0; dir < 2; ++dir)
+                destination[axis][dir].resize(n * n * n);
+            for (int slot = 0; slot < n * n * n; ++slot)
+            {
+                int p[3];
+                SlotPosition(n, slot, p[0], p[1], p[2]);
+                if (SurfaceSlot(n, slot))
+                {
+                    slots[axis][LayerOf(n, p[axis])].push_back(slot);
+                    slots[axis][n].push_back(slot);
+                }
+                for (int dir = 0; dir < 2; ++dir)
+                {
+                    int x = p[0], y = p[1], z = p[2];
+                    RotateQuarter(axis, dir ? 1 : -1, x, y, z);
+                    destination[axis][dir][slot] = SlotIndex(n, x, y, z);
+                }
+            }
+        }
+    }
+};
+
+inline int LayerIndex(const LayerTurn& turn, int size)
+{
+    return turn.layer == LAYER_ALL ? size : turn.layer;
+}
+
+#endif //RUBIK_LAYERS_H
@@ -0,0 +1,223 @@
+#ifndef RUBIK_LOG_H
+#define RUBIK_LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Leveled logging.
+// A message is formatted on the calling thread and pushed into a fixed size ring;
+// a background thread writes the ring to stderr in batches with one flush per
+// batch, so no caller ever waits on the terminal or a redirected journal.
+// When the ring is full the oldest message is dropped and the loss is reported.
+//
+// Usage: LOG_INFO("solution with " << n << " moves");
+//        LOG_EVERY(LOG_LEVEL::DEBUG, 1.0, "angle " << a); // at most once per second
+//
+// Levels below RUBIK_LOG_MIN_LEVEL are compiled out: by default everything is
+// kept in debug builds and only WARN and ERROR in release (NDEBUG) builds.
+// Defining RUBIK_LOG_ENABLED to 0 removes all of them.
+
+enum class LOG_LEVEL { TRACE, DEBUG, INFO, WARN, ERROR };
+
+#ifndef RUBIK_LOG_ENABLED
+#define RUBIK_LOG_ENABLED 1
+#endif
+
+#ifndef RUBIK_LOG_MIN_LEVEL
+#ifdef NDEBUG
+#define RUBIK_LOG_MIN_LEVEL 3 // LOG_LEVEL::WARN
+#else
+#define RUBIK_LOG_MIN_LEVEL 0 // LOG_LEVEL::TRACE
+#endif
+#endif
+
+class Logger
+{
+public:
+    static const size_t CAPACITY = 1024;
+
+    static Logger& Get()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    // runtime threshold on top of the compile time one
+    void SetLevel(LOG_LEVEL level)
+    {
+        minLevel = (int)level;
+    }
+    bool Enabled(LOG_LEVEL level) const
+    {
+        return (int)level >= minLevel.load(std::memory_order_relaxed);
+    }
+
+    void Push(LOG_LEVEL level, const char* file, int line, std::string text)
+    {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (count == CAPACITY)
+            {
+                head = (head + 1) % CAPACITY;
+                --count;
+                ++dropped;
+            }
+            Entry& entry = ring[(head + count) % CAPACITY];
+            entry.level = level;
+            entry.seconds = seconds;
+            entry.file = file;
+            entry.line = line;
+            entry.text.swap(text);
+            ++count;
+        }
+        wake.notify_one();
+    }
+
+    ~Logger()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        wake.notify_one();
+        if (worker.joinable())
+            worker.join();
+    }
+
+private:
+    struct Entry
+    {
+        LOG_LEVEL level;
+        double seconds;
+        const char* file;
+        int line;
+        std::string text;
+    };
+
+    Logger() : ring(CAPACITY), start(std::chrono::steady_clock::now())
+    {
+        worker = std::thread([this]() { Run(); });
+    }
+
+    static const char* Name(LOG_LEVEL level)
+    {
+        static const char* names[] = { "TRACE", "DEBUG", "INFO", "WARN", "ERROR" };
+        return names[(int)level];
+    }
+
+    // writer thread: takes everything queued at once and writes it outside the lock
+    void Run()
+    {
+        std::vector<Entry> batch;
+        for (;;)
+        {
+            size_t lost;
+            bool last;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return count > 0 || stop; });
+                for (; count > 0; --count)
+                {
+                    batch.push_back(std::move(ring[head]));
+                    head = (head + 1) % CAPACITY;
+                }
+                lost = dropped;
+                dropped = 0;
+                last = stop;
+            }
+            if (lost > 0)
+                std::fprintf(stderr, "[WARN] log ring full, %zu messages dropped\n", lost);
+            for (const Entry& entry : batch)
+                std::fprintf(stderr, "[%9.3f %-5s %s:%d] %s\n", entry.seconds, Name(entry.level),
+                             entry.file, entry.line, entry.text.c_str());
+            if (!batch.empty() || lost > 0)
+                std::fflush(stderr);
+            batch.clear();
+            if (last)
+                return;
+        }
+    }
+
+    std::vector<Entry> ring;
+    size_t head = 0;
+    size_t count = 0;
+    size_t dropped = 0;
+    bool stop = false;
+    std::atomic<int> minLevel{ 0 };
+    std::chrono::steady_clock::time_point start;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::thread worker;
+};
+
+// lets one call site through at most once per interval and counts the rest
+class LogRateLimit
+{
+public:
+    explicit LogRateLimit(double seconds)
+        : interval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(seconds)).count())
+    {
+    }
+
+    // true when the message may be written; suppressed is how many were skipped since the last one
+    bool Allow(long& suppressed)
+    {
+        long long now = std::chrono::steady_clock::now().time_since_epoch().count();
+        long long due = next.load(std::memory_order_relaxed);
+        if (now < due || !next.compare_exchange_strong(due, now + interval))
+        {
+            ++skipped;
+            return false;
+        }
+        suppressed = skipped.exchange(0);
+        return true;
+    }
+
+private:
+    long long interval;
+    std::atomic<long long> next{ 0 };
+    std::atomic<long> skipped{ 0 };
+};
+
+#define RUBIK_LOG_ACTIVE(level) \
+    (RUBIK_LOG_ENABLED && (int)(level) >= RUBIK_LOG_MIN_LEVEL && Logger::Get().Enabled(level))
+
+#define LOG_AT(level, message) \
+    do { \
+        if (RUBIK_LOG_ACTIVE(level)) { \
+            std::ostringstream logStream_; \
+            logStream_ << message; \
+            Logger::Get().Push(level, __FILE__, __LINE__, logStream_.str()); \
+        } \
+    } while (0)
+
+#define LOG_EVERY(level, seconds, message) \
+    do { \
+        if (RUBIK_LOG_ACTIVE(level)) { \
+            static LogRateLimit logLimit_(seconds); \
+            long logSuppressed_ = 0; \
+            if (logLimit_.Allow(logSuppressed_)) { \
+                std::ostringstream logStream_; \
+                logStream_ << message; \
+                if (logSuppressed_ > 0) \
+                    logStream_ << " (" << logSuppressed_ << " more suppressed)"; \
+                Logger::Get().Push(level, __FILE__, __LINE__, logStream_.str()); \
+            } \
+        } \
+    } while (0)
+
+#define LOG_TRACE(message) LOG_AT(LOG_LEVEL::TRACE, message)
+#define LOG_DEBUG(message) LOG_AT(LOG_LEVEL::DEBUG, message)
+#define LOG_INFO(message) LOG_AT(LOG_LEVEL::INFO, message)
+#define LOG_WARN(message) LOG_AT(LOG_LEVEL::WARN, message)
+#define LOG_ERROR(message) LOG_AT(LOG_LEVEL::ERROR, message)
+
+#endif //RUBIK_LOG_H
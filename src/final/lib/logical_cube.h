@@ -0,0 +1,103 @@
+#ifndef RUBIK_LOGICAL_CUBE_H
+#define RUBIK_LOGICAL_CUBE_H
+
+#include "cube_n.h"
+#include "cube_state.h"
+#include "orientation.h"
+#include "solver.h"
+
+// Reads the stickers of a CubeState in the layout of solver::Rubik, so the
+// cubie state is the only state the program keeps and the solver view is
+// derived from it whenever a solve is requested.
+
+// colour letter solver::Rubik uses for the face an outward normal points to
+inline char FaceColor(int axis, int sign)
+{
+    static const char positive[3] = { 'r', 'w', 'g' }; // right, up, front
+    static const char negative[3] = { 'o', 'y', 'l' }; // left, down, back
+    return sign > 0 ? positive[axis] : negative[axis];
+}
+
+// colour of the sticker at slot (x, y, z), doubled coordinates, facing the outward normal (axis, sign)
+inline char StickerAt(const CubeState& state, int x, int y, int z, int axis, int sign)
+{
+    int cubie = state.occupant[SlotIndex(state.size, x, y, z)];
+    const int (*m)[3] = OrientationTable::Get().matrix[state.orientation[cubie]];
+    // the normal in the cubie frame is the transpose of its rotation times the world normal;
+    // a cubie carries on each local direction the colour of the face it looked at when solved
+    for (int k = 0; k < 3; ++k)
+        if (m[axis][k] != 0)
+            return FaceColor(k, m[axis][k] * sign);
+    return 'f';
+}
+
+// only for a 3x3x3: the slots below are -1, 0, 1 and get scaled to doubled coordinates
+inline solver::Rubik ToRubik(const CubeState& state)
+{
+    const int k = state.size - 1;
+    // faces as (axis, sign)
+    const int U[2] = { 1, 1 }, D[2] = { 1, -1 }, F[2] = { 2, 1 };
+    const int B[2] = { 2, -1 }, R[2] = { 0, 1 }, L[2] = { 0, -1 };
+    struct CenterSlot { int x, y, z; const int* face; };
+    struct EdgeSlot { int x, y, z; const int* up; const int* down; };
+    struct CornerSlot { int x, y, z; const int* up; const int* left; const int* right; };
+    // piece order and sticker roles of solver::Rubik (see Rubik::Rubik())
+    const CenterSlot centers[6] = {
+        { 0, 1, 0, U }, { 0, 0, 1, F }, { 1, 0, 0, R }, { 0, 0, -1, B }, { -1, 0, 0, L }, { 0, -1, 0, D }
+    };
+    const EdgeSlot edges[12] = {
+        { 0, 1, 1, U, F }, { 1, 1, 0, U, R }, { 0, 1, -1, U, B }, { -1, 1, 0, U, L },
+        { 0, -1, 1, D, F }, { 1, -1, 0, D, R }, { 0, -1, -1, D, B }, { -1, -1, 0, D, L },
+        { 1, 0, 1, F, R }, { 1, 0, -1, B, R }, { -1, 0, -1, B, L }, { -1, 0, 1, F, L }
+    };
+    const CornerSlot corners[8] = {
+        { -1, 1, 1, U, L, F }, { 1, 1, 1, U, F, R }, { 1, 1, -1, U, R, B }, { -1, 1, -1, U, B, L },
+        { -1, -1, 1, D, L, F }, { 1, -1, 1, D, F, R }, { 1, -1, -1, D, R, B }, { -1, -1, -1, D, B, L }
+    };
+
+    solver::Rubik rubik;
+    for (int i = 0; i < 6; ++i)
+    {
+        const CenterSlot& c = centers[i];
+        solver::Center piece;
+        piece.center = StickerAt(state, c.x * k, c.y * k, c.z * k, c.face[0], c.face[1]);
+        rubik.setCenter(i, piece);
+    }
+    for (int i = 0; i < 12; ++i)
+    {
+        const EdgeSlot& e = edges[i];
+        solver::Edge piece;
+        piece.up = StickerAt(state, e.x * k, e.y * k, e.z * k, e.up[0], e.up[1]);
+        piece.down = StickerAt(state, e.x * k, e.y * k, e.z * k, e.down[0], e.down[1]);
+        rubik.setEdge(i, piece);
+    }
+    for (int i = 0; i < 8; ++i)
+    {
+        const CornerSlot& c = corners[i];
+        solver::Corner piece;
+        piece.up = StickerAt(state, c.x * k, c.y * k, c.z * k, c.up[0], c.up[1]);
+        piece.left = StickerAt(state, c.x * k, c.y * k, c.z * k, c.left[0], c.left[1]);
+        piece.right = StickerAt(state, c.x * k, c.y * k, c.z * k, c.right[0], c.right[1]);
+        rubik.setCorner(i, piece);
+    }
+    return rubik;
+}
+
+// any size: every sticker of solver::CubeN read where CubeN says it is
+inline solver::CubeN ToCubeN(const CubeState& state)
+{
+    solver::CubeN cube(state.size);
+    for (int face = 0; face < 6; ++face)
+        for (int row = 0; row < state.size; ++row)
+            for (int column = 0; column < state.size; ++column)
+            {
+                int position[3], normal[3];
+                solver::CubeN::stickerPlace(state.size, face, row, column, position, normal);
+                int axis = normal[0] != 0 ? 0 : normal[1] != 0 ? 1 : 2;
+                cube.setSticker(face, row, column,
+                                StickerAt(state, position[0], position[1], position[2], axis, normal[axis]));
+            }
+    return cube;
+}
+
+#endif //RUBIK_LOGICAL_CUBE_H
@@ -0,0 +1,220 @@
+#ifndef RUBIK_MOVE_TABLE_H
+#define RUBIK_MOVE_TABLE_H
+
+// Turns of solver::Rubik as tables, built at compile time. A table says, for
+// every edge and corner position, which position its piece comes from and how
+// the stickers of the piece land on the fields of the new position; composing
+// two gives the table of the turns one after the other. The quarter turns below
+// are the ones the hand-written movements did; halves, inverses and the turns
+// seen from a rotated cube are derived from them, and the static_asserts at the
+// end check the group they make, so a wrong entry fails the build.
+// Rubik::turn<MOVE>() applies a table with every index a constant, so each
+// movement compiles to the few copies of the pieces it moves.
+
+namespace solver {
+
+    struct MoveTable {
+        unsigned char edgeFrom[12];      // position whose edge lands here
+        bool edgeFlip[12];               // its down sticker goes to the up field
+        unsigned char cornerFrom[8];     // position whose corner lands here
+        unsigned char cornerField[8][3]; // field (0 up, 1 left, 2 right) of that corner for up, left and right
+    };
+
+    constexpr MoveTable identityMove()
+    {
+        MoveTable m = {};
+        for (int i = 0; i < 12; ++i)
+            m.edgeFrom[i] = (unsigned char)i;
+        for (int i = 0; i < 8; ++i)
+        {
+            m.cornerFrom[i] = (unsigned char)i;
+            for (int k = 0; k < 3; ++k)
+                m.cornerField[i][k] = (unsigned char)k;
+        }
+        return m;
+    }
+
+    // first a, then b
+    constexpr MoveTable compose(const MoveTable& a, const MoveTable& b)
+    {
+        MoveTable m = {};
+        for (int i = 0; i < 12; ++i)
+        {
+            m.edgeFrom[i] = a.edgeFrom[b.edgeFrom[i]];
+            m.edgeFlip[i] = a.edgeFlip[b.edgeFrom[i]] != b.edgeFlip[i];
+        }
+        for (int i = 0; i < 8; ++i)
+        {
+            m.cornerFrom[i] = a.cornerFrom[b.cornerFrom[i]];
+            for (int k = 0; k < 3; ++k)
+                m.cornerField[i][k] = a.cornerField[b.cornerFrom[i]][b.cornerField[i][k]];
+        }
+        return m;
+    }
+
+    constexpr MoveTable inverse(const MoveTable& a)
+    {
+        MoveTable m = {};
+        for (int i = 0; i < 12; ++i)
+        {
+            m.edgeFrom[a.edgeFrom[i]] = (unsigned char)i;
+            m.edgeFlip[a.edgeFrom[i]] = a.edgeFlip[i];
+        }
+        for (int i = 0; i < 8; ++i)
+        {
+            m.cornerFrom[a.cornerFrom[i]] = (unsigned char)i;
+            for (int k = 0; k < 3; ++k)
+                m.cornerField[a.cornerFrom[i]][a.cornerField[i][k]] = (unsigned char)k;
+        }
+        return m;
+    }
+
+    constexpr MoveTable power(const MoveTable& a, int times)
+    {
+        MoveTable m = identityMove();
+        for (int i = 0; i < times; ++i)
+            m = compose(m, a);
+        return m;
+    }
+
+    // turn a as seen from the cube moved by s: undo s, turn, move it back
+    constexpr MoveTable conjugate(const MoveTable& a, const MoveTable& s)
+    {
+        return compose(compose(inverse(s), a), s);
+    }
+
+    constexpr bool sameMove(const MoveTable& a, const MoveTable& b)
+    {
+        for (int i = 0; i < 12; ++i)
+            if (a.edgeFrom[i] != b.edgeFrom[i] || a.edgeFlip[i] != b.edgeFlip[i])
+                return false;
+        for (int i = 0; i < 8; ++i)
+        {
+            if (a.cornerFrom[i] != b.cornerFrom[i])
+                return false;
+            for (int k = 0; k < 3; ++k)
+                if (a.cornerField[i][k] != b.cornerField[i][k])
+                    return false;
+        }
+        return true;
+    }
+
+    // The same turn as a gather over the 48 stickers, edges first (up, down of each
+    // position) then corners (up, left, right): sticker k takes the one at from[k]
+    struct StickerTable {
+        unsigned char from[48];
+    };
+
+    constexpr StickerTable stickers(const MoveTable& m)
+    {
+        StickerTable t = {};
+        for (int i = 0; i < 12; ++i)
+        {
+            t.from[i * 2] = (unsigned char)(m.edgeFrom[i] * 2 + (m.edgeFlip[i] ? 1 : 0));
+            t.from[i * 2 + 1] = (unsigned char)(m.edgeFrom[i] * 2 + (m.edgeFlip[i] ? 0 : 1));
+        }
+        for (int i = 0; i < 8; ++i)
+            for (int k = 0; k < 3; ++k)
+                t.from[24 + i * 3 + k] = (unsigned char)(24 + m.cornerFrom[i] * 3 + m.cornerField[i][k]);
+        return t;
+    }
+
+    // quarter turns, clockwise seen from the face
+    constexpr MoveTable TURN_U = {
+        { 1, 2, 3, 0, 4, 5, 6, 7, 8, 9, 10, 11 },
+        { false, false, false, false, false, false, false, false, false, false, false, false },
+        { 1, 2, 3, 0, 4, 5, 6, 7 },
+        { { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 } }
+    };
+    constexpr MoveTable TURN_F = {
+        { 11, 1, 2, 3, 8, 5, 6, 7, 0, 9, 10, 4 },
+        { true, false, false, false, true, false, false, false, true, false, false, true },
+        { 4, 0, 2, 3, 5, 1, 6, 7 },
+        { { 1, 0, 2 }, { 1, 2, 0 }, { 0, 1, 2 }, { 0, 1, 2 }, { 2, 0, 1 }, { 2, 1, 0 }, { 0, 1, 2 }, { 0, 1, 2 } }
+    };
+    constexpr MoveTable TURN_R = {
+        { 0, 8, 2, 3, 4, 9, 6, 7, 5, 1, 10, 11 },
+        { false, false, false, false, false, false, false, false, false, false, false, false },
+        { 0, 5, 1, 3, 4, 6, 2, 7 },
+        { { 0, 1, 2 }, { 1, 0, 2 }, { 1, 2, 0 }, { 0, 1, 2 }, { 0, 1, 2 }, { 2, 0, 1 }, { 2, 1, 0 }, { 0, 1, 2 } }
+    };
+    constexpr MoveTable TURN_B = {
+        { 0, 1, 9, 3, 4, 5, 10, 7, 8, 6, 2, 11 },
+        { false, false, true, false, false, false, true, false, false, true, true, false },
+        { 0, 1, 6, 2, 4, 5, 7, 3 },
+        { { 0, 1, 2 }, { 0, 1, 2 }, { 1, 0, 2 }, { 1, 2, 0 }, { 0, 1, 2 }, { 0, 1, 2 }, { 2, 0, 1 }, { 2, 1, 0 } }
+    };
+    constexpr MoveTable TURN_L = {
+        { 0, 1, 2, 10, 4, 5, 6, 11, 8, 9, 7, 3 },
+        { false, false, false, false, false, false, false, false, false, false, false, false },
+        { 3, 1, 2, 7, 0, 5, 6, 4 },
+        { { 1, 2, 0 }, { 0, 1, 2 }, { 0, 1, 2 }, { 1, 0, 2 }, { 2, 1, 0 }, { 0, 1, 2 }, { 0, 1, 2 }, { 2, 0, 1 } }
+    };
+    constexpr MoveTable TURN_D = {
+        { 0, 1, 2, 3, 7, 4, 5, 6, 8, 9, 10, 11 },
+        { false, false, false, false, false, false, false, false, false, false, false, false },
+        { 0, 1, 2, 3, 7, 4, 5, 6 },
+        { { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 } }
+    };
+
+    // the whole cube turned like U (the middle ring too, its edges changing their up field)
+    constexpr MoveTable ROTATION_Y = {
+        { 1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8 },
+        { false, false, false, false, false, false, false, false, true, true, true, true },
+        { 1, 2, 3, 0, 5, 6, 7, 4 },
+        { { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 }, { 0, 1, 2 } }
+    };
+
+    // index of each turn in MOVE_TABLES: face * 3 + 0 quarter, 1 half, 2 inverse
+    enum MoveIndex {
+        MOVE_U, MOVE_U2, MOVE_u, MOVE_F, MOVE_F2, MOVE_f, MOVE_R, MOVE_R2, MOVE_r,
+        MOVE_B, MOVE_B2, MOVE_b, MOVE_L, MOVE_L2, MOVE_l, MOVE_D, MOVE_D2, MOVE_d,
+        MOVE_COUNT
+    };
+
+    constexpr MoveTable MOVE_TABLES[MOVE_COUNT] = {
+        TURN_U, power(TURN_U, 2), inverse(TURN_U),
+        TURN_F, power(TURN_F, 2), inverse(TURN_F),
+        TURN_R, power(TURN_R, 2), inverse(TURN_R),
+        TURN_B, power(TURN_B, 2), inverse(TURN_B),
+        TURN_L, power(TURN_L, 2), inverse(TURN_L),
+        TURN_D, power(TURN_D, 2), inverse(TURN_D)
+    };
+
+    constexpr bool checkFaces()
+    {
+        for (int face = 0; face < 6; ++face)
+        {
+            const MoveTable& quarter = MOVE_TABLES[face * 3];
+            if (sameMove(quarter, identityMove()) || sameMove(power(quarter, 2), identityMove()) ||
+                !sameMove(power(quarter, 4), identityMove()) ||
+                !sameMove(compose(quarter, MOVE_TABLES[face * 3 + 2]), identityMove()) ||
+                !sameMove(power(MOVE_TABLES[face * 3 + 2], 3), quarter))
+                return false;
+        }
+        return true;
+    }
+    static_assert(checkFaces(), "every quarter turn has order 4 and its inverse undoes it");
+    static_assert(sameMove(compose(TURN_U, TURN_D), compose(TURN_D, TURN_U)) &&
+                  sameMove(compose(TURN_F, TURN_B), compose(TURN_B, TURN_F)) &&
+                  sameMove(compose(TURN_R, TURN_L), compose(TURN_L, TURN_R)),
+                  "opposite faces commute");
+    static_assert(!sameMove(compose(TURN_R, TURN_U), compose(TURN_U, TURN_R)), "adjacent faces don't commute");
+    static_assert(sameMove(power(compose(compose(TURN_R, TURN_U), compose(inverse(TURN_R), inverse(TURN_U))), 6),
+                           identityMove()),
+                  "R U R' U' has order 6");
+    static_assert(sameMove(power(compose(TURN_R, TURN_U), 105), identityMove()) &&
+                  !sameMove(power(compose(TURN_R, TURN_U), 35), identityMove()) &&
+                  !sameMove(power(compose(TURN_R, TURN_U), 21), identityMove()) &&
+                  !sameMove(power(compose(TURN_R, TURN_U), 15), identityMove()),
+                  "R U has order 105");
+    static_assert(sameMove(power(ROTATION_Y, 4), identityMove()), "y has order 4");
+    static_assert(sameMove(conjugate(TURN_U, ROTATION_Y), TURN_U) && sameMove(conjugate(TURN_D, ROTATION_Y), TURN_D),
+                  "y keeps U and D");
+    static_assert(sameMove(conjugate(TURN_R, ROTATION_Y), TURN_F) && sameMove(conjugate(TURN_F, ROTATION_Y), TURN_L) &&
+                  sameMove(conjugate(TURN_L, ROTATION_Y), TURN_B) && sameMove(conjugate(TURN_B, ROTATION_Y), TURN_R),
+                  "y takes each side face to the next one");
+
+} // namespace solver
+
+#endif //RUBIK_MOVE_TABLE_H
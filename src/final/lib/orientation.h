@@ -0,0 +1,108 @@
+#ifndef RUBIK_ORIENTATION_H
+#define RUBIK_ORIENTATION_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "layers.h"
+
+// The 24 rotations of the cube as integer matrices.
+// A cubie at rest is fully described by its grid position and the index of its
+// orientation in this table, so no floating point error accumulates across
+// turns: the float transform is rebuilt from integers every time a turn ends.
+struct OrientationTable
+{
+    static const int COUNT = 24;
+    int matrix[COUNT][3][3];    // matrix[o][row][col]
+    glm::quat rotation[COUNT];  // same rotation as a quaternion
+    int afterTurn[COUNT][3][2]; // orientation after a quarter turn around (axis, direction > 0)
+
+    static const OrientationTable& Get()
+    {
+        static const OrientationTable table;
+        return table;
+    }
+
+    // exact rest transform of a cubie: translation to its slot times its rotation
+    glm::mat4 Model(int orientation, const glm::vec3& position) const
+    {
+        glm::mat4 model(1.0f);
+        for (int col = 0; col < 3; ++col)
+            for (int row = 0; row < 3; ++row)
+                model[col][row] = (float)matrix[orientation][row][col];
+        model[3] = glm::vec4(position, 1.0f);
+        return model;
+    }
+
+private:
+    static void QuarterTurn(int axis, int direction, int q[3][3])
+    {
+        for (int col = 0; col < 3; ++col)
+        {
+            int v[3] = { 0, 0, 0 };
+            v[col] = 1;
+            RotateQuarter(axis, direction, v[0], v[1], v[2]);
+            for (int row = 0; row < 3; ++row)
+                q[row][col] = v[row];
+        }
+    }
+    static void Multiply(const int a[3][3], const int b[3][3], int out[3][3])
+    {
+        for (int row = 0; row < 3; ++row)
+            for (int col = 0; col < 3; ++col)
+            {
+                out[row][col] = 0;
+                for (int k = 0; k < 3; ++k)
+                    out[row][col] += a[row][k] * b[k][col];
+            }
+    }
+    int Find(const int m[3][3], int known) const
+    {
+        for (int o = 0; o < known; ++o)
+        {
+            bool equal = true;
+            for (int row = 0; row < 3 && equal; ++row)
+                for (int col = 0; col < 3 && equal; ++col)
+                    equal = matrix[o][row][col] == m[row][col];
+            if (equal)
+                return o;
+        }
+        return -1;
+    }
+
+    OrientationTable()
+    {
+        // breadth first closure of the identity under the six quarter turns
+        for (int row = 0; row < 3; ++row)
+            for (int col = 0; col < 3; ++col)
+                matrix[0][row][col] = row == col ? 1 : 0;
+        int known = 1;
+        for (int o = 0; o < known; ++o)
+            for (int axis = 0; axis < 3; ++axis)
+                for (int dir = 0; dir < 2; ++dir)
+                {
+                    int q[3][3], m[3][3];
+                    QuarterTurn(axis, dir ? 1 : -1, q);
+                    Multiply(q, matrix[o], m);
+                    int found = Find(m, known);
+                    if (found < 0)
+                    {
+                        found = known++;
+                        for (int row = 0; row < 3; ++row)
+                            for (int col = 0; col < 3; ++col)
+                                matrix[found][row][col] = m[row][col];
+                    }
+                    afterTurn[o][axis][dir] = found;
+                }
+        for (int o = 0; o < COUNT; ++o)
+        {
+            glm::mat3 m(1.0f);
+            for (int col = 0; col < 3; ++col)
+                for (int row = 0; row < 3; ++row)
+                    m[col][row] = (float)matrix[o][row][col];
+            rotation[o] = glm::normalize(glm::quat_cast(m));
+        }
+    }
+};
+
+#endif //RUBIK_ORIENTATION_H
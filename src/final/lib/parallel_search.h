@@ -0,0 +1,115 @@
+#ifndef RUBIK_PARALLEL_SEARCH_H
+#define RUBIK_PARALLEL_SEARCH_H
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Pieces for a tree search on every core. The caller splits the tree a few
+// levels down into tasks (the nodes of that depth) and hands them to a
+// WorkStealingPool; the workers share a SearchBound with the length of the best
+// solution found so far, so a branch that can't beat it is cut on every core,
+// and a stop flag that ends all of them at once (a solution good enough, the
+// time over, a cancel).
+namespace solver {
+
+    struct SearchBound
+    {
+        std::atomic<int> best;
+        std::atomic<bool> stop{ false };
+
+        explicit SearchBound(int limit) : best(limit)
+        {
+        }
+
+        // lowers best to length; false if a solution as short was found before
+        bool improve(int length)
+        {
+            int old = best.load(std::memory_order_relaxed);
+            while (length < old && !best.compare_exchange_weak(old, length, std::memory_order_relaxed))
+            {
+            }
+            return length < old;
+        }
+    };
+
+    // Every worker has a deque of tasks: it takes its own from the front and, once
+    // they are over, steals from the back of the others, so the ones that got the
+    // big subtrees are helped instead of left alone at the end. The tasks are dealt
+    // round robin, neighbours in the list (often of the same size) to different
+    // workers. A deque has its own lock, taken once per task.
+    template <typename Task>
+    class WorkStealingPool
+    {
+    public:
+        // threads 0 uses every core
+        explicit WorkStealingPool(int threads = 0)
+            : count(threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency())),
+              queues(count)
+        {
+        }
+
+        int threads() const
+        {
+            return count;
+        }
+
+        // work(task, worker) for every task, worker in [0, threads()); returns when all are done.
+        // The calling thread is worker 0
+        template <typename WORK>
+        void run(const std::vector<Task>& tasks, WORK work)
+        {
+            for (size_t i = 0; i < tasks.size(); ++i)
+                queues[i % count].tasks.push_back(tasks[i]);
+            auto worker = [&](int self) {
+                Task task;
+                while (take(self, task))
+                    work(task, self);
+            };
+            std::vector<std::thread> workers;
+            for (int i = 1; i < count; ++i)
+                workers.emplace_back(worker, i);
+            worker(0);
+            for (size_t i = 0; i < workers.size(); ++i)
+                workers[i].join();
+        }
+
+    private:
+        struct Queue
+        {
+            std::mutex lock;
+            std::deque<Task> tasks;
+        };
+        int count;
+        std::vector<Queue> queues;
+
+        bool take(int self, Task& task)
+        {
+            for (int k = 0; k < count; ++k)
+            {
+                Queue& queue = queues[(self + k) % count];
+                std::lock_guard<std::mutex> guard(queue.lock);
+                if (queue.tasks.empty())
+                    continue;
+                if (k == 0)
+                {
+                    task = queue.tasks.front();
+                    queue.tasks.pop_front();
+                }
+                else
+                {
+                    task = queue.tasks.back();
+                    queue.tasks.pop_back();
+                }
+                return true;
+            }
+            return false;
+        }
+    };
+
+} // namespace solver
+
+#endif //RUBIK_PARALLEL_SEARCH_H
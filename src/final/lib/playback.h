@@ -0,0 +1,80 @@
+#ifndef RUBIK_PLAYBACK_H
+#define RUBIK_PLAYBACK_H
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+// Timeline over a solution: which move comes next, whether it is playing, and
+// checkpoints of the state so any move index can be reached without animating
+// the moves in between.
+// State is whatever the owner needs to rebuild the scene and Move one step of
+// the solution; apply(state, move) must advance it by one move instantly.
+template <typename State, typename Move = char>
+class SolvePlayback
+{
+public:
+    // a checkpoint every CHECKPOINT_EVERY moves bounds a seek to that many instant moves
+    static const size_t CHECKPOINT_EVERY = 16;
+    bool Playing = false;
+
+    void Load(const std::vector<Move>& solution, const State& start, std::function<void(State&, const Move&)> applyMove)
+    {
+        moves = solution;
+        apply = applyMove;
+        cursor = 0;
+        Playing = false;
+        checkpoints.clear();
+        State state = start;
+        for (size_t i = 0; i < moves.size(); ++i)
+        {
+            if (i % CHECKPOINT_EVERY == 0)
+                checkpoints.push_back(state);
+            apply(state, moves[i]);
+        }
+        lastState = state;
+    }
+    void Clear()
+    {
+        moves.clear();
+        checkpoints.clear();
+        cursor = 0;
+        Playing = false;
+    }
+
+    size_t Size() const { return moves.size(); }
+    size_t Cursor() const { return cursor; }
+    bool HasNext() const { return cursor < moves.size(); }
+    bool HasPrevious() const { return cursor > 0; }
+    const Move& Next() const { return moves[cursor]; }
+    const Move& Previous() const { return moves[cursor - 1]; }
+
+    // the owner finished animating Next() (forward) or the inverse of Previous() (back)
+    void Advanced() { if (cursor < moves.size()) ++cursor; }
+    void Retreated() { if (cursor > 0) --cursor; }
+
+    // state after the first index moves: nearest checkpoint plus less than CHECKPOINT_EVERY moves
+    State StateAt(size_t index) const
+    {
+        if (index >= moves.size())
+            return lastState;
+        size_t checkpoint = index / CHECKPOINT_EVERY;
+        State state = checkpoints[checkpoint];
+        for (size_t i = checkpoint * CHECKPOINT_EVERY; i < index; ++i)
+            apply(state, moves[i]);
+        return state;
+    }
+    void SetCursor(size_t index)
+    {
+        cursor = index > moves.size() ? moves.size() : index;
+    }
+
+private:
+    std::vector<Move> moves;
+    std::vector<State> checkpoints; // state before moves 0, CHECKPOINT_EVERY, 2 * CHECKPOINT_EVERY...
+    State lastState;
+    std::function<void(State&, const Move&)> apply;
+    size_t cursor = 0;
+};
+
+#endif //RUBIK_PLAYBACK_H
@@ -0,0 +1,293 @@
+#ifndef RUBIK_PNG_WRITER_H
+#define RUBIK_PNG_WRITER_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// Minimal PNG encoder, enough for screenshots and recorded frames.
+// Each row gets the PNG filter with the smallest sum of absolute values and the
+// filtered data is compressed with LZ77 (hash chains, greedy matching) and the
+// fixed Huffman codes of deflate, so no zlib is needed.
+
+namespace png {
+
+// deflate stream, bits are packed starting from the least significant one
+class BitWriter
+{
+public:
+    std::vector<uint8_t> bytes;
+
+    void Bits(uint32_t value, int count)
+    {
+        buffer |= value << used;
+        used += count;
+        while (used >= 8)
+        {
+            bytes.push_back((uint8_t)buffer);
+            buffer >>= 8;
+            used -= 8;
+        }
+    }
+    // Huffman codes are defined most significant bit first
+    void Code(uint32_t code, int length)
+    {
+        uint32_t reversed = 0;
+        for (int i = 0; i < length; ++i)
+            reversed |= ((code >> i) & 1u) << (length - 1 - i);
+        Bits(reversed, length);
+    }
+    void Finish()
+    {
+        if (used > 0)
+            bytes.push_back((uint8_t)buffer);
+        buffer = 0;
+        used = 0;
+    }
+
+private:
+    uint32_t buffer = 0;
+    int used = 0;
+};
+
+inline void Literal(BitWriter& out, int symbol)
+{
+    if (symbol < 144)
+        out.Code(0x30 + symbol, 8);
+    else if (symbol < 256)
+        out.Code(0x190 + symbol - 144, 9);
+    else if (symbol < 280)
+        out.Code(symbol - 256, 7);
+    else
+        out.Code(0xC0 + symbol - 280, 8);
+}
+
+inline void Match(BitWriter& out, int length, int distance)
+{
+    static const int lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    static const int lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                         3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    static const int distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                          257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+                                          8193, 12289, 16385, 24577 };
+    static const int distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                           7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    int l = 28;
+    while (lengthBase[l] > length)
+        --l;
+    Literal(out, 257 + l);
+    out.Bits(length - lengthBase[l], lengthExtra[l]);
+    int d = 29;
+    while (distanceBase[d] > distance)
+        --d;
+    out.Code(d, 5);
+    out.Bits(distance - distanceBase[d], distanceExtra[d]);
+}
+
+// zlib stream (RFC 1950) holding one fixed Huffman deflate block (RFC 1951)
+inline std::vector<uint8_t> ZlibCompress(const std::vector<uint8_t>& data)
+{
+    const int WINDOW = 32768;
+    const int HASH_SIZE = 1 << 15;
+    const int MAX_CHAIN = 32;
+    const int MIN_MATCH = 3;
+    const int MAX_MATCH = 258;
+
+    BitWriter out;
+    out.bytes.push_back(0x78); // deflate, 32K window
+    out.bytes.push_back(0x01); // no dictionary, fastest level; header is a multiple of 31
+    out.Bits(1, 1);            // last block
+    out.Bits(1, 2);            // fixed Huffman codes
+
+    const int size = (int)data.size();
+    std::vector<int> head(HASH_SIZE, -1);
+    std::vector<int> previous(WINDOW, -1);
+    auto hash = [&](int i) {
+        return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & (HASH_SIZE - 1);
+    };
+    auto insert = [&](int i) {
+        if (i + MIN_MATCH > size)
+            return;
+        int h = hash(i);
+        previous[i & (WINDOW - 1)] = head[h];
+        head[h] = i;
+    };
+
+    int i = 0;
+    while (i < size)
+    {
+        int bestLength = 0;
+        int bestDistance = 0;
+        if (i + MIN_MATCH <= size)
+        {
+            int candidate = head[hash(i)];
+            int limit = size - i < MAX_MATCH ? size - i : MAX_MATCH;
+            for (int chain = 0; candidate >= 0 && i - candidate <= WINDOW && chain < MAX_CHAIN; ++chain)
+            {
+                int length = 0;
+                while (length < limit && data[candidate + length] == data[i + length])
+                    ++length;
+                if (length > bestLength)
+                {
+                    bestLength = length;
+                    bestDistance = i - candidate;
+                    if (length == limit)
+                        break;
+                }
+                int next = previous[candidate & (WINDOW - 1)];
+                if (next >= candidate)
+                    break; // slot reused by a newer position, the chain ends here
+                candidate = next;
+            }
+        }
+        if (bestLength >= MIN_MATCH)
+        {
+            Match(out, bestLength, bestDistance);
+            for (int k = 0; k < bestLength; ++k)
+                insert(i + k);
+            i += bestLength;
+        }
+        else
+        {
+            Literal(out, data[i]);
+            insert(i);
+            ++i;
+        }
+    }
+    Literal(out, 256); // end of block
+    out.Finish();
+
+    uint32_t a = 1, b = 0;
+    for (uint8_t byte : data)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    uint32_t adler = (b << 16) | a;
+    for (int shift = 24; shift >= 0; shift -= 8)
+        out.bytes.push_back((uint8_t)(adler >> shift));
+    return out.bytes;
+}
+
+struct CrcTable
+{
+    uint32_t entry[256];
+
+    CrcTable()
+    {
+        for (uint32_t n = 0; n < 256; ++n)
+        {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k)
+                c = c & 1 ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entry[n] = c;
+        }
+    }
+};
+
+inline uint32_t Crc32(const uint8_t* data, size_t size, uint32_t crc = 0)
+{
+    // the encoder threads call this at once: a local static is built by exactly one of them
+    static const CrcTable table;
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+        crc = table.entry[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+inline int Paeth(int a, int b, int c)
+{
+    int p = a + b - c;
+    int pa = std::abs(p - a), pb = std::abs(p - b), pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc)
+        return a;
+    return pb <= pc ? b : c;
+}
+
+// rows of channels bytes per pixel (3 = RGB, 4 = RGBA), top to bottom
+inline std::vector<uint8_t> Encode(int width, int height, int channels, const uint8_t* pixels)
+{
+    const size_t row = (size_t)width * channels;
+    std::vector<uint8_t> filtered;
+    filtered.reserve((row + 1) * height);
+    std::vector<uint8_t> candidate(row);
+    std::vector<uint8_t> best(row);
+    for (int y = 0; y < height; ++y)
+    {
+        const uint8_t* line = pixels + row * y;
+        const uint8_t* up = y > 0 ? line - row : nullptr;
+        long bestScore = -1;
+        int bestFilter = 0;
+        for (int filter = 0; filter < 5; ++filter)
+        {
+            long score = 0;
+            for (size_t x = 0; x < row; ++x)
+            {
+                int left = x >= (size_t)channels ? line[x - channels] : 0;
+                int above = up ? up[x] : 0;
+                int corner = up && x >= (size_t)channels ? up[x - channels] : 0;
+                int predicted = 0;
+                switch (filter)
+                {
+                    case 1: predicted = left; break;
+                    case 2: predicted = above; break;
+                    case 3: predicted = (left + above) / 2; break;
+                    case 4: predicted = Paeth(left, above, corner); break;
+                }
+                candidate[x] = (uint8_t)(line[x] - predicted);
+                score += std::abs((int8_t)candidate[x]);
+            }
+            if (bestScore < 0 || score < bestScore)
+            {
+                bestScore = score;
+                bestFilter = filter;
+                best.swap(candidate);
+            }
+        }
+        filtered.push_back((uint8_t)bestFilter);
+        filtered.insert(filtered.end(), best.begin(), best.end());
+    }
+
+    std::vector<uint8_t> file = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    auto chunk = [&file](const char* type, const std::vector<uint8_t>& body) {
+        uint32_t length = (uint32_t)body.size();
+        for (int shift = 24; shift >= 0; shift -= 8)
+            file.push_back((uint8_t)(length >> shift));
+        size_t start = file.size();
+        file.insert(file.end(), type, type + 4);
+        file.insert(file.end(), body.begin(), body.end());
+        uint32_t crc = Crc32(&file[start], file.size() - start);
+        for (int shift = 24; shift >= 0; shift -= 8)
+            file.push_back((uint8_t)(crc >> shift));
+    };
+    std::vector<uint8_t> header;
+    for (uint32_t value : { (uint32_t)width, (uint32_t)height })
+        for (int shift = 24; shift >= 0; shift -= 8)
+            header.push_back((uint8_t)(value >> shift));
+    header.push_back(8);                          // bits per channel
+    header.push_back(channels == 4 ? 6 : 2);      // RGBA or RGB
+    header.push_back(0);                          // deflate
+    header.push_back(0);                          // adaptive filtering
+    header.push_back(0);                          // no interlace
+    chunk("IHDR", header);
+    chunk("IDAT", ZlibCompress(filtered));
+    chunk("IEND", std::vector<uint8_t>());
+    return file;
+}
+
+inline bool Write(const std::string& path, int width, int height, int channels, const uint8_t* pixels)
+{
+    std::vector<uint8_t> file = Encode(width, height, channels, pixels);
+    FILE* out = std::fopen(path.c_str(), "wb");
+    if (!out)
+        return false;
+    bool ok = std::fwrite(file.data(), 1, file.size(), out) == file.size();
+    return std::fclose(out) == 0 && ok;
+}
+
+} // namespace png
+
+#endif //RUBIK_PNG_WRITER_H
@@ -0,0 +1,210 @@
+#ifndef RUBIK_PROFILER_H
+#define RUBIK_PROFILER_H
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Frame profiler for the render loop.
+// Every named section keeps a fixed histogram of its durations (0.1 ms buckets
+// up to 50 ms), so recording a sample is O(1) and percentiles can be read at
+// any time without keeping the samples. While a trace is being captured each
+// sample is also kept as a Chrome trace event ("X" phase), which can be opened
+// in chrome://tracing or ui.perfetto.dev.
+// It is meant to be used from the render thread only.
+class Profiler
+{
+public:
+    static const int MAX_SECTIONS = 16;
+    static const int BUCKETS = 500;
+    static constexpr double BUCKET_MS = 0.1;
+    static const size_t MAX_TRACE_EVENTS = 500000; // about 2 minutes of 10 sections at 400 fps
+
+    struct Stats
+    {
+        const char* name;
+        unsigned long count;
+        double mean, p50, p95, p99, max; // milliseconds
+    };
+
+    Profiler() : start(std::chrono::steady_clock::now()) {}
+
+    // seconds since the profiler was created
+    double Now() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // id of a section, registered on first use; names must outlive the profiler (string literals)
+    int Section(const char* name)
+    {
+        for (int i = 0; i < sectionCount; ++i)
+            if (sections[i].name == name || std::strcmp(sections[i].name, name) == 0)
+                return i;
+        if (sectionCount == MAX_SECTIONS)
+            return MAX_SECTIONS - 1; // shared overflow section, better than losing the sample
+        sections[sectionCount].name = name;
+        return sectionCount++;
+    }
+
+    // thread is the trace lane: 1 for the CPU, 2 for GPU timings
+    void Record(int section, double startSeconds, double seconds, int thread = 1)
+    {
+        Histogram& h = sections[section];
+        double ms = seconds * 1000.0;
+        int bucket = (int)(ms / BUCKET_MS);
+        ++h.buckets[bucket < 0 ? 0 : (bucket >= BUCKETS ? BUCKETS - 1 : bucket)];
+        ++h.count;
+        h.total += ms;
+        if (ms > h.max)
+            h.max = ms;
+        if (tracing && events.size() < MAX_TRACE_EVENTS)
+            events.push_back({ section, thread, startSeconds, seconds });
+    }
+
+    void BeginFrame()
+    {
+        frameStart = Now();
+    }
+    void EndFrame()
+    {
+        Record(Section("frame"), frameStart, Now() - frameStart);
+    }
+
+    Stats Get(int section) const
+    {
+        const Histogram& h = sections[section];
+        Stats stats = { h.name, h.count, 0.0, 0.0, 0.0, 0.0, h.max };
+        if (h.count == 0)
+            return stats;
+        stats.mean = h.total / h.count;
+        stats.p50 = Percentile(h, 0.50);
+        stats.p95 = Percentile(h, 0.95);
+        stats.p99 = Percentile(h, 0.99);
+        return stats;
+    }
+    int SectionCount() const
+    {
+        return sectionCount;
+    }
+    void ResetStats()
+    {
+        for (int i = 0; i < sectionCount; ++i)
+        {
+            const char* name = sections[i].name;
+            sections[i] = Histogram();
+            sections[i].name = name;
+        }
+    }
+
+    // one line per section: name, samples, mean and percentiles in milliseconds
+    std::string Summary() const
+    {
+        std::ostringstream out;
+        char line[160];
+        for (int i = 0; i < sectionCount; ++i)
+        {
+            Stats s = Get(i);
+            std::snprintf(line, sizeof(line), "%-12s n=%-7lu mean=%6.2f p50=%6.2f p95=%6.2f p99=%6.2f max=%7.2f ms\n",
+                          s.name, s.count, s.mean, s.p50, s.p95, s.p99, s.max);
+            out << line;
+        }
+        return out.str();
+    }
+
+    bool Tracing() const
+    {
+        return tracing;
+    }
+    void StartTrace()
+    {
+        events.clear();
+        tracing = true;
+    }
+    // stops the capture and writes it as Chrome trace JSON; false if the file can't be written
+    bool StopTrace(const std::string& path)
+    {
+        tracing = false;
+        FILE* file = std::fopen(path.c_str(), "w");
+        if (!file)
+            return false;
+        std::fprintf(file, "{\"traceEvents\":[\n");
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            const Event& e = events[i];
+            std::fprintf(file, "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}%s\n",
+                         sections[e.section].name, e.start * 1e6, e.duration * 1e6, e.thread,
+                         i + 1 < events.size() ? "," : "");
+        }
+        std::fprintf(file, "],\"displayTimeUnit\":\"ms\"}\n");
+        std::fclose(file);
+        events.clear();
+        return true;
+    }
+
+private:
+    struct Histogram
+    {
+        const char* name = "";
+        unsigned long buckets[BUCKETS] = {};
+        unsigned long count = 0;
+        double total = 0.0;
+        double max = 0.0;
+    };
+    struct Event
+    {
+        int section;
+        int thread;
+        double start, duration; // seconds
+    };
+
+    // upper edge of the bucket holding the p-th sample, never above the real maximum
+    static double Percentile(const Histogram& h, double p)
+    {
+        unsigned long target = (unsigned long)(p * h.count);
+        if (target == 0)
+            target = 1;
+        unsigned long seen = 0;
+        for (int i = 0; i < BUCKETS; ++i)
+        {
+            seen += h.buckets[i];
+            if (seen >= target)
+            {
+                double edge = (i + 1) * BUCKET_MS;
+                return edge < h.max ? edge : h.max;
+            }
+        }
+        return h.max;
+    }
+
+    std::chrono::steady_clock::time_point start;
+    Histogram sections[MAX_SECTIONS];
+    int sectionCount = 0;
+    double frameStart = 0.0;
+    bool tracing = false;
+    std::vector<Event> events;
+};
+
+// measures the enclosing block as one sample of a section
+class ProfileScope
+{
+public:
+    ProfileScope(Profiler& profiler_, const char* name)
+        : profiler(profiler_), section(profiler_.Section(name)), begin(profiler_.Now())
+    {
+    }
+    ~ProfileScope()
+    {
+        profiler.Record(section, begin, profiler.Now() - begin);
+    }
+
+private:
+    Profiler& profiler;
+    int section;
+    double begin;
+};
+
+#endif //RUBIK_PROFILER_H
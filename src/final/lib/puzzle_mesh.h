@@ -0,0 +1,150 @@
+#ifndef RUBIK_PUZZLE_MESH_H
+#define RUBIK_PUZZLE_MESH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <vector>
+
+// The whole puzzle as one static mesh: the faces of every cubie in a single
+// vertex buffer, each vertex tagged with the id of its cubie. The vertex shader
+// takes the transform of the cubie from a uniform buffer (std140 mat4 array,
+// "Cubies" block) that is refreshed once per frame, so all the cubies are drawn
+// with one call no matter how they move.
+//
+// The outward faces (the stickers) come first in the index buffer and the faces
+// hidden inside the assembled cube after them. Those can only be seen while a
+// layer is turning, so they are drawn only then; with the cube at rest about two
+// thirds of the triangles of the per-cubie drawing are never rasterized.
+struct MeshVertex
+{
+    float position[3]; // on the unit cube of the cubie
+    float uv[2];
+    float color[3];    // colour of the face, black for the hidden ones
+    GLint cubie;
+};
+
+struct PuzzleMesh
+{
+    std::vector<MeshVertex> vertices;
+    std::vector<GLuint> indices;
+    GLsizei stickerIndices = 0; // indices [0, stickerIndices) are the outward faces
+
+    // unitVertices: 4 vertices (x y z u v) per face, faceIndices: 6 per face, as in the
+    // single cube VAO. faceColor(cubie, face, rgb) fills the colour and returns false for
+    // a face hidden inside the cube; cubies for which skip(cubie) holds are left out.
+    template <typename FACE_COLOR, typename SKIP>
+    static PuzzleMesh Build(int cubies, int faces, const float* unitVertices, const GLuint* faceIndices,
+                            FACE_COLOR faceColor, SKIP skip)
+    {
+        PuzzleMesh mesh;
+        std::vector<GLuint> hidden;
+        for (int cubie = 0; cubie < cubies; ++cubie)
+        {
+            if (skip(cubie))
+                continue;
+            for (int face = 0; face < faces; ++face)
+            {
+                float rgb[3] = { 0.0f, 0.0f, 0.0f };
+                bool outward = faceColor(cubie, face, rgb);
+                GLuint base = (GLuint)mesh.vertices.size();
+                for (int k = 0; k < 4; ++k)
+                {
+                    const float* source = unitVertices + (face * 4 + k) * 5;
+                    MeshVertex vertex = { { source[0], source[1], source[2] }, { source[3], source[4] },
+                                          { rgb[0], rgb[1], rgb[2] }, cubie };
+                    mesh.vertices.push_back(vertex);
+                }
+                std::vector<GLuint>& target = outward ? mesh.indices : hidden;
+                for (int k = 0; k < 6; ++k)
+                    target.push_back(base + faceIndices[face * 6 + k] - face * 4);
+            }
+        }
+        mesh.stickerIndices = (GLsizei)mesh.indices.size();
+        mesh.indices.insert(mesh.indices.end(), hidden.begin(), hidden.end());
+        return mesh;
+    }
+};
+
+// GPU side of a PuzzleMesh: VAO, vertex and index buffers and the uniform buffer
+// with the cubie transforms (bound to binding point BINDING).
+class PuzzleMeshRenderer
+{
+public:
+    static const GLuint BINDING = 0;
+    // surface cubies of a 7x7x7, the size of models[] in meshVertex.shader; the whole
+    // block is allocated whatever the puzzle, as GL wants a bound range that covers it
+    static const int MAX_CUBIES = 218;
+
+    void Init(const PuzzleMesh& mesh, int cubies)
+    {
+        cubieCount = cubies;
+        stickerIndices = mesh.stickerIndices;
+        totalIndices = (GLsizei)mesh.indices.size();
+
+        glGenVertexArrays(1, &vao);
+        glGenBuffers(1, &vbo);
+        glGenBuffers(1, &ebo);
+        glBindVertexArray(vao);
+        glBindBuffer(GL_ARRAY_BUFFER, vbo);
+        glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(MeshVertex), mesh.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(GLuint), mesh.indices.data(), GL_STATIC_DRAW);
+        glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, position));
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, uv));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(MeshVertex), (void*)offsetof(MeshVertex, color));
+        glEnableVertexAttribArray(2);
+        glVertexAttribIPointer(3, 1, GL_INT, sizeof(MeshVertex), (void*)offsetof(MeshVertex, cubie));
+        glEnableVertexAttribArray(3);
+        glBindVertexArray(0);
+
+        glGenBuffers(1, &ubo);
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferData(GL_UNIFORM_BUFFER, MAX_CUBIES * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+    void Release()
+    {
+        glDeleteVertexArrays(1, &vao);
+        glDeleteBuffers(1, &vbo);
+        glDeleteBuffers(1, &ebo);
+        glDeleteBuffers(1, &ubo);
+        vao = vbo = ebo = ubo = 0;
+    }
+    bool Ready() const
+    {
+        return vao != 0;
+    }
+
+    // connects the "Cubies" block of a program to the transform buffer
+    static void BindProgram(GLuint program)
+    {
+        GLuint block = glGetUniformBlockIndex(program, "Cubies");
+        if (block != GL_INVALID_INDEX)
+            glUniformBlockBinding(program, block, BINDING);
+    }
+
+    // std140 lays out a mat4 array exactly like glm, so the matrices are copied as they are
+    void Draw(const glm::mat4* models, bool hiddenFaces, long& drawCalls)
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, ubo);
+        glBufferSubData(GL_UNIFORM_BUFFER, 0, cubieCount * sizeof(glm::mat4), models);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        glBindBufferBase(GL_UNIFORM_BUFFER, BINDING, ubo);
+
+        glBindVertexArray(vao);
+        glDrawElements(GL_TRIANGLES, hiddenFaces ? totalIndices : stickerIndices, GL_UNSIGNED_INT, (void*)0);
+        ++drawCalls;
+    }
+
+private:
+    GLuint vao = 0, vbo = 0, ebo = 0, ubo = 0;
+    int cubieCount = 0;
+    GLsizei stickerIndices = 0;
+    GLsizei totalIndices = 0;
+};
+
+#endif //RUBIK_PUZZLE_MESH_H
@@ -2,6 +2,7 @@
 // Created by saulr on 8/22/2021.
 //
 #include "shader.h"
+#include "log.h"
 
 // PRIVATE METHODS
 void Shader::checkCompileErrors(GLuint shader, Shader::ShaderType sType)
@@ -30,7 +31,7 @@ void Shader::checkCompileErrors(GLuint shader, Shader::ShaderType sType)
         if (!success)
         {
             glGetShaderInfoLog(shader, 1024, NULL, infoLog);
-            std::cout << "ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            LOG_ERROR("ERROR::SHADER_COMPILATION_ERROR of type: " << type << "\n" << infoLog);
         }
     }
     else
@@ -39,7 +40,7 @@ void Shader::checkCompileErrors(GLuint shader, Shader::ShaderType sType)
         if (!success)
         {
             glGetProgramInfoLog(shader, 1024, NULL, infoLog);
-            std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
+            LOG_ERROR("ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog);
         }
     }
 }
@@ -75,7 +76,7 @@ void Shader::ConfShaders(const char* vertexPath, const char* fragmentPath)
         fragmentCode = fShaderStream.str();
     }
     catch (std::ifstream::failure e) {
-        std::cerr << "ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ" << std::endl;
+        LOG_ERROR("ERROR::SHADER::FILE_NOT_SUCCESFULLY_READ");
     }
     const char* vShaderCode = vertexCode.c_str();
     const char* fShaderCode = fragmentCode.c_str();
@@ -0,0 +1,45 @@
+#ifndef RUBIK_SNAPSHOT_H
+#define RUBIK_SNAPSHOT_H
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Everything the renderer needs to draw the cube for one frame: the final model
+// matrix of every cubie, turn and global transform already applied.
+// It is built by the owner of the cube state and never modified once published.
+struct CubeSnapshot
+{
+    std::vector<glm::mat4> model; // one per cubie of the cube, see CubeState
+    bool turning = false; // a layer is mid-turn: the faces between layers can be seen
+    glm::vec3 center = glm::vec3(0.0f); // bounding sphere of the whole cube, for frustum culling
+    float radius = 0.0f;
+};
+
+// Hand-off of the latest snapshot between the code that updates the cube and
+// the code that draws it. A reader keeps the snapshot it got alive for as long
+// as it holds the pointer, so publishing never waits for a frame to finish.
+template <typename T>
+class SnapshotChannel
+{
+public:
+    void Publish(const T& value)
+    {
+        std::shared_ptr<const T> snapshot = std::make_shared<const T>(value);
+        std::lock_guard<std::mutex> lock(mutex);
+        latest.swap(snapshot);
+    }
+    std::shared_ptr<const T> Latest() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return latest;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::shared_ptr<const T> latest;
+};
+
+#endif //RUBIK_SNAPSHOT_H
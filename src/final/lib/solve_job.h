@@ -0,0 +1,150 @@
+#ifndef RUBIK_SOLVE_JOB_H
+#define RUBIK_SOLVE_JOB_H
+
+#include <chrono>
+#include <future>
+#include <memory>
+#include <vector>
+
+#include "cube_n.h"
+#include "solver.h"
+
+// Runs solver::Rubik::solve (or solver::CubeN::solve) on a worker thread so the render loop never waits
+// for it. The loop calls Poll() once per frame; it returns true exactly once,
+// on the frame the solution becomes available. A solve that fails (no solution,
+// a stage over its budget) ends the job too: Poll() returns false and Failed()
+// holds, with the reason and the stage counters in Result().
+// Cancel() does not block: the worker stops at the next stage boundary or loop round and its
+// result is dropped. Abandoned workers are only waited for when they finish on
+// their own or when the job is destroyed.
+class SolveJob
+{
+public:
+    solver::SolveBudget Budget; // of each stage, for the jobs started from now on
+
+    ~SolveJob()
+    {
+        Cancel();
+    }
+
+    bool Running() const
+    {
+        return running;
+    }
+
+    // solves a copy of rubik with method ('B' beginners, 'C' CFOP, 'S' fewest turns search); a job still running is cancelled first
+    void Start(const solver::Rubik& rubik, char method = 'B')
+    {
+        Cancel();
+        state = std::make_shared<Shared>();
+        std::shared_ptr<Shared> shared = state;
+        solver::Rubik copy(rubik);
+        solver::SolveBudget budget = Budget;
+        result = std::async(std::launch::async, [shared, copy, method, budget]() mutable {
+            return copy.solve(shared->moves, shared->progress, method, budget);
+        });
+        running = true;
+        failed = false;
+    }
+    // the same for a cube of any size; its solution comes out of the Poll() that takes slice turns
+    void Start(const solver::CubeN& cube, char method = 'B')
+    {
+        Cancel();
+        state = std::make_shared<Shared>();
+        std::shared_ptr<Shared> shared = state;
+        solver::CubeN copy(cube);
+        solver::SolveBudget budget = Budget;
+        result = std::async(std::launch::async, [shared, copy, method, budget]() mutable {
+            return copy.solve(shared->turns, shared->progress, method, budget);
+        });
+        running = true;
+        failed = false;
+    }
+
+    bool Poll(std::vector<char>& solution)
+    {
+        if (!Finished())
+            return false;
+        solution.swap(state->moves);
+        return true;
+    }
+    bool Poll(std::vector<solver::SliceTurn>& solution)
+    {
+        if (!Finished())
+            return false;
+        solution.swap(state->turns);
+        return true;
+    }
+
+    // the last solve that finished failed
+    bool Failed() const
+    {
+        return failed;
+    }
+    // outcome of the last solve that finished
+    const solver::SolveResult& Result() const
+    {
+        return last;
+    }
+
+    void Cancel()
+    {
+        if (!running)
+            return;
+        state->progress.cancel = true;
+        retired.push_back(std::move(result));
+        running = false;
+    }
+
+    // fraction of the solver stages finished, in [0, 1]
+    float Progress() const
+    {
+        if (!state)
+            return 0.0f;
+        return (float)state->progress.stagesDone / solver::SolveProgress::STAGES;
+    }
+
+private:
+    // lives as long as the worker or the job, whichever goes last
+    struct Shared
+    {
+        solver::SolveProgress progress;
+        std::vector<char> moves;
+        std::vector<solver::SliceTurn> turns;
+    };
+
+    // true once, when the worker ended with a solution
+    bool Finished()
+    {
+        Prune();
+        if (!running || result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return false;
+        running = false;
+        last = result.get();
+        failed = !last.success;
+        return last.success;
+    }
+
+    void Prune()
+    {
+        for (size_t i = 0; i < retired.size();)
+        {
+            if (retired[i].wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                retired[i] = std::move(retired.back());
+                retired.pop_back();
+            }
+            else
+                ++i;
+        }
+    }
+
+    std::shared_ptr<Shared> state;
+    std::future<solver::SolveResult> result;
+    std::vector<std::future<solver::SolveResult>> retired; // cancelled workers still finishing their stage
+    solver::SolveResult last;
+    bool running = false;
+    bool failed = false;
+};
+
+#endif //RUBIK_SOLVE_JOB_H
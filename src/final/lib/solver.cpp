@@ -5,8 +5,15 @@
 #include <ctype.h>
 #include <time.h>
 #include <string.h>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include "solver.h"
+#include "move_table.h"
+#include "distance_table.h"
+#include "two_phase.h"
+#include "log.h"
 using namespace std;
 
 #define RESET         "\x1b[0m"
@@ -72,126 +79,88 @@ namespace solver {
 		return number;
 	}
 	int Rubik::searchEdge(const char& ar, const char& ab) const {
-		int position;
-		if ((edge[0].up == ar && edge[0].down == ab) || (edge[0].up == ab && edge[0].down == ar))
-			position = 0;
-		else if ((edge[1].up == ar && edge[1].down == ab) || (edge[1].up == ab && edge[1].down == ar))
-			position = 1;
-		else if ((edge[2].up == ar && edge[2].down == ab) || (edge[2].up == ab && edge[2].down == ar))
-			position = 2;
-		else if ((edge[3].up == ar && edge[3].down == ab) || (edge[3].up == ab && edge[3].down == ar))
-			position = 3;
-		else if ((edge[4].up == ar && edge[4].down == ab) || (edge[4].up == ab && edge[4].down == ar))
-			position = 4;
-		else if ((edge[5].up == ar && edge[5].down == ab) || (edge[5].up == ab && edge[5].down == ar))
-			position = 5;
-		else if ((edge[6].up == ar && edge[6].down == ab) || (edge[6].up == ab && edge[6].down == ar))
-			position = 6;
-		else if ((edge[7].up == ar && edge[7].down == ab) || (edge[7].up == ab && edge[7].down == ar))
-			position = 7;
-		else if ((edge[8].up == ar && edge[8].down == ab) || (edge[8].up == ab && edge[8].down == ar))
-			position = 8;
-		else if ((edge[9].up == ar && edge[9].down == ab) || (edge[9].up == ab && edge[9].down == ar))
-			position = 9;
-		else if ((edge[10].up == ar && edge[10].down == ab) || (edge[10].up == ab && edge[10].down == ar))
-			position = 10;
-		else if ((edge[11].up == ar && edge[11].down == ab) || (edge[11].up == ab && edge[11].down == ar))
-			position = 11;
-
-		return position;
+		if (!indexed)
+			indexPieces();
+		return edgeAt[pieceKey(ar, ab)];
 	}
 	int Rubik::searchCorner(const char& a, const char& iz, const char& de) const {
-		int position;
-		if (((corner[0].up == a) && (corner[0].left == iz) && (corner[0].right == de)) ||
-			((corner[0].up == a) && (corner[0].left == de) && (corner[0].right == iz)) ||
-			((corner[0].up == iz) && (corner[0].left == a) && (corner[0].right == de)) ||
-			((corner[0].up == de) && (corner[0].left == iz) && (corner[0].right == a)) ||
-			((corner[0].up == de) && (corner[0].left == a) && (corner[0].right == iz)) ||
-			((corner[0].up == iz) && (corner[0].left == de) && (corner[0].right == a)))
-			position = 0;
-		else if (((corner[1].up == a) && (corner[1].left == iz) && (corner[1].right == de)) ||
-			((corner[1].up == a) && (corner[1].left == de) && (corner[1].right == iz)) ||
-			((corner[1].up == iz) && (corner[1].left == a) && (corner[1].right == de)) ||
-			((corner[1].up == de) && (corner[1].left == iz) && (corner[1].right == a)) ||
-			((corner[1].up == de) && (corner[1].left == a) && (corner[1].right == iz)) ||
-			((corner[1].up == iz) && (corner[1].left == de) && (corner[1].right == a)))
-			position = 1;
-		else if (((corner[2].up == a) && (corner[2].left == iz) && (corner[2].right == de)) ||
-			((corner[2].up == a) && (corner[2].left == de) && (corner[2].right == iz)) ||
-			((corner[2].up == iz) && (corner[2].left == a) && (corner[2].right == de)) ||
-			((corner[2].up == de) && (corner[2].left == iz) && (corner[2].right == a)) ||
-			((corner[2].up == de) && (corner[2].left == a) && (corner[2].right == iz)) ||
-			((corner[2].up == iz) && (corner[2].left == de) && (corner[2].right == a)))
-			position = 2;
-		else if (((corner[3].up == a) && (corner[3].left == iz) && (corner[3].right == de)) ||
-			((corner[3].up == a) && (corner[3].left == de) && (corner[3].right == iz)) ||
-			((corner[3].up == iz) && (corner[3].left == a) && (corner[3].right == de)) ||
-			((corner[3].up == de) && (corner[3].left == iz) && (corner[3].right == a)) ||
-			((corner[3].up == de) && (corner[3].left == a) && (corner[3].right == iz)) ||
-			((corner[3].up == iz) && (corner[3].left == de) && (corner[3].right == a)))
-			position = 3;
-		else if (((corner[4].up == a) && (corner[4].left == iz) && (corner[4].right == de)) ||
-			((corner[4].up == a) && (corner[4].left == de) && (corner[4].right == iz)) ||
-			((corner[4].up == iz) && (corner[4].left == a) && (corner[4].right == de)) ||
-			((corner[4].up == de) && (corner[4].left == iz) && (corner[4].right == a)) ||
-			((corner[4].up == de) && (corner[4].left == a) && (corner[4].right == iz)) ||
-			((corner[4].up == iz) && (corner[4].left == de) && (corner[4].right == a)))
-			position = 4;
-		else if (((corner[5].up == a) && (corner[5].left == iz) && (corner[5].right == de)) ||
-			((corner[5].up == a) && (corner[5].left == de) && (corner[5].right == iz)) ||
-			((corner[5].up == iz) && (corner[5].left == a) && (corner[5].right == de)) ||
-			((corner[5].up == de) && (corner[5].left == iz) && (corner[5].right == a)) ||
-			((corner[5].up == de) && (corner[5].left == a) && (corner[5].right == iz)) ||
-			((corner[5].up == iz) && (corner[5].left == de) && (corner[5].right == a)))
-			position = 5;
-		else if (((corner[6].up == a) && (corner[6].left == iz) && (corner[6].right == de)) ||
-			((corner[6].up == a) && (corner[6].left == de) && (corner[6].right == iz)) ||
-			((corner[6].up == iz) && (corner[6].left == a) && (corner[6].right == de)) ||
-			((corner[6].up == de) && (corner[6].left == iz) && (corner[6].right == a)) ||
-			((corner[6].up == de) && (corner[6].left == a) && (corner[6].right == iz)) ||
-			((corner[6].up == iz) && (corner[6].left == de) && (corner[6].right == a)))
-			position = 6;
-		else if (((corner[7].up == a) && (corner[7].left == iz) && (corner[7].right == de)) ||
-			((corner[7].up == a) && (corner[7].left == de) && (corner[7].right == iz)) ||
-			((corner[7].up == iz) && (corner[7].left == a) && (corner[7].right == de)) ||
-			((corner[7].up == de) && (corner[7].left == iz) && (corner[7].right == a)) ||
-			((corner[7].up == de) && (corner[7].left == a) && (corner[7].right == iz)) ||
-			((corner[7].up == iz) && (corner[7].left == de) && (corner[7].right == a)))
-			position = 7;
-		else
-			cout << "Problem with corner (" << a << "," << iz << "," << de << ").\n";
-
+		if (!indexed)
+			indexPieces();
+		int position = cornerAt[pieceKey(a, iz, de)];
+		if (position < 0)
+			LOG_WARN("Problem with corner (" << a << "," << iz << "," << de << ").");
 		return position;
 	}
-	void Rubik::sequence(const string& sec, vector<char>& solution) {
-		for (unsigned int i = 0; i < sec.size(); ++i) {
-			if (sec[i] == 'R')
-				R(solution);
-			else if (sec[i] == 'r')
-				r(solution);
-			else if (sec[i] == 'L')
-				L(solution);
-			else if (sec[i] == 'l')
-				l(solution);
-			else if (sec[i] == 'D')
-				D(solution);
-			else if (sec[i] == 'd')
-				d(solution);
-			else if (sec[i] == 'U')
-				U(solution);
-			else if (sec[i] == 'u')
-				u(solution);
-			else if (sec[i] == 'F')
-				F(solution);
-			else if (sec[i] == 'f')
-				f(solution);
-			else if (sec[i] == 'B')
-				B(solution);
-			else if (sec[i] == 'b')
-				b(solution);
-			else
-				cerr << "Error: invalid movement " << sec[i] << endl;
+	// bit of each colour in pieceKey(), 0 for any other char
+	static const struct ColourBits {
+		unsigned char of[256];
+		ColourBits() : of() {
+			of['w'] = 1; of['o'] = 2; of['g'] = 4; of['r'] = 8; of['l'] = 16; of['y'] = 32;
+		}
+	} COLOUR_BITS;
+	int Rubik::pieceKey(const char& a, const char& b, const char& c) {
+		return COLOUR_BITS.of[(unsigned char)a] | COLOUR_BITS.of[(unsigned char)b] | COLOUR_BITS.of[(unsigned char)c];
+	}
+	void Rubik::indexPieces() const {
+		memset(edgeAt, -1, sizeof(edgeAt));
+		memset(cornerAt, -1, sizeof(cornerAt));
+		for (int i = 0; i < 12; ++i)
+			edgeAt[pieceKey(edge[i].up, edge[i].down)] = i;
+		for (int i = 0; i < 8; ++i)
+			cornerAt[pieceKey(corner[i].up, corner[i].left, corner[i].right)] = i;
+		indexed = true;
+	}
+	struct Rubik::CompiledSequence {
+		StickerTable move;
+		string notation; // chars for the solution, B written as W
+	};
+	const Rubik::CompiledSequence& Rubik::compileSequence(const string& sec) {
+		// every thread looks in its own map first: the solves running at once only take the
+		// lock of the shared one the first time a thread meets a string. Entries are never
+		// removed, so the references handed out stay valid
+		thread_local unordered_map<string, const CompiledSequence*> seen;
+		unordered_map<string, const CompiledSequence*>::iterator hit = seen.find(sec);
+		if (hit != seen.end())
+			return *hit->second;
+
+		static mutex lock;
+		static unordered_map<string, CompiledSequence> cache;
+		lock_guard<mutex> guard(lock);
+		unordered_map<string, CompiledSequence>::iterator found = cache.find(sec);
+		if (found == cache.end()) {
+			static const char letters[] = "UuFfRrBbLlDd";
+			static const int moves[] = { MOVE_U, MOVE_u, MOVE_F, MOVE_f, MOVE_R, MOVE_r,
+				MOVE_B, MOVE_b, MOVE_L, MOVE_l, MOVE_D, MOVE_d };
+			MoveTable move = identityMove();
+			CompiledSequence compiled;
+			for (unsigned int i = 0; i < sec.size(); ++i) {
+				const char* letter = sec[i] != 0 ? strchr(letters, sec[i]) : nullptr;
+				if (letter == nullptr) {
+					LOG_ERROR("Invalid movement '" << sec[i] << "' in sequence " << sec);
+					continue;
+				}
+				move = compose(move, MOVE_TABLES[moves[letter - letters]]);
+				compiled.notation += sec[i] == 'B' ? 'W' : (sec[i] == 'b' ? 'w' : sec[i]);
+			}
+			compiled.move = stickers(move);
+			found = cache.emplace(sec, compiled).first;
 		}
+		seen.emplace(sec, &found->second);
+		return found->second;
+	}
+	void Rubik::sequence(const string& sec, vector<char>& solution) {
+		const CompiledSequence& compiled = compileSequence(sec);
+		apply(compiled.move);
+		solution.insert(solution.end(), compiled.notation.begin(), compiled.notation.end());
+	}
+	bool Rubik::nextIteration() {
+		if (run == nullptr)
+			return true;
+		++run->stats->iterations;
+		if (run->stats->iterations > run->budget->iterations || run->progress->cancel ||
+			chrono::steady_clock::now() > run->deadline)
+			run->stopped = true;
+		return !run->stopped;
 	}
 
 
@@ -882,7 +851,7 @@ namespace solver {
 		// Orientate final edgess:
 		repeat = true;
 		int contador = 0;
-		while (repeat) {
+		while (repeat && nextIteration()) {
 			if ((edge[4].down == 'r') && (edge[5].down == 'g') &&
 				(edge[6].down == 'l') && (edge[7].down == 'o')) { // bdBdbD2Bd '¬'
 				sequence("bdBdbDDBd", solution);
@@ -938,7 +907,7 @@ namespace solver {
 	}
 	void Rubik::permutationFinalCorners(vector<char>& solution) {
 		bool repeat = true;
-		while (repeat) {
+		while (repeat && nextIteration()) {
 			if (searchCorner('y', 'o', 'g') == 4) {
 				if (searchCorner('y', 'r', 'l') == 5) // rDLdRDld
 					sequence("rDLdRDld", solution);
@@ -1073,6 +1042,473 @@ namespace solver {
 	}
 
 
+	// CFOP method
+	// Algorithms in the letters of sequence(), with the white face up: the last layer is the
+	// bottom (yellow) one, so they are the usual ones turned upside down (z2).
+
+	// F2L: one insertion per case of the front-right slot (corner 1, edge 8), shortest
+	// found with F, R and D turns. The other slots use them turned around the vertical axis.
+	static const int F2L_COUNT = 41;
+	static const char* const F2L_CASES[F2L_COUNT] = {
+		// corner and edge in the bottom layer
+		"rDR", "fDDFFDFFDF", "FdfDDrdR", "FdfDFDf", "FFDDRFFrDDFF", "FDf",
+		"RRDDfRFDDRR", "FDfDFDf", "rDRdrdR", "rDRDDFDf", "FDDfDrdR", "Fdf",
+		"FdfDrdR", "FDfDDFdf", "rdR", "FDDfDDFdf", "rDDRDrdR", "FFDDfdFdFF",
+		"RRDDRDrDRR", "FDDfdFDf", "FDfrdR", "FDDFFRFr", "rDDRRfrF", "rdRFDf",
+		// edge already in the slot
+		"FDDfDFDf", "rdRdFDf", "FdfDDFdf", "FDfDrdR", "FFDFFDFFDDFF", "rDDRFDf",
+		// corner already in the slot
+		"fRFRRdR", "FdFFRFr", "rDRRfrF", "rDRFDf", "FDDfDDrdR", "rDDRDDFDf",
+		// both in the slot, wrong
+		"FFDDfdFdfDDf", "FRDFdfrdf", "FDDFDfDFDDFF", "FDRFDfdrf", "FdFDDRFFrDDFF"
+	};
+	// takes whatever is in the front-right slot out to the bottom layer
+	static const char* const F2L_EXTRACT = "rDR";
+	// slot s: corner and edge positions, and the faces its algorithms use instead of F, R, B, L
+	static const int SLOT_CORNER[4] = { 1, 2, 3, 0 };
+	static const int SLOT_EDGE[4] = { 8, 9, 10, 11 };
+	static const char* const SLOT_FACES[4] = { "FRBL", "RBLF", "BLFR", "LFRB" };
+
+	static const int OLL_COUNT = 57;
+	static const char* const OLL_CASES[OLL_COUNT] = {
+		"LDDLLFLfDDlFLf", // OLL 1
+		"FLDldfBDRdrb", // OLL 2
+		"BDRdrbdFLDldf", // OLL 3
+		"BDRdrbDFLDldf", // OLL 4
+		"rBBLBlBR", // OLL 5
+		"RFFlfLfr", // OLL 6
+		"RFlFLFFr", // OLL 7
+		"rbLblBBR", // OLL 8
+		"LDldlFLLDldf", // OLL 9
+		"LDlDlFLfLDDl", // OLL 10
+		"RFlFlULuLFFr", // OLL 11
+		"lRlfLflFFLfLr", // OLL 12
+		"FDLdLLfLDLdl", // OLL 13
+		"lFLDlfLFdf", // OLL 14
+		"rbRldLDrBR", // OLL 15
+		"RFrLDldRfr", // OLL 16
+		"LDlDlFLfDDlFLf", // OLL 17
+		"RFlFLFFRRbLblBBR", // OLL 18
+		"LrBLBlblRlFLf", // OLL 19
+		"RFlfLLRRBLblblR", // OLL 20
+		"LDDldLDldLdl", // OLL 21
+		"LDDLLdLLdLLDDL", // OLL 22
+		"LLuLDDlULDDL", // OLL 23
+		"RFlfrFLf", // OLL 24
+		"fRFlfrFL", // OLL 25
+		"LDDldLdl", // OLL 26
+		"LDlDLDDl", // OLL 27
+		"RFlfLrDLdl", // OLL 28
+		"LDldLdlfdFLDl", // OLL 29
+		"FlFLLdldLDlFF", // OLL 30
+		"ldFDLdlfL", // OLL 31
+		"RDfdrDRFr", // OLL 32
+		"LDldlFLf", // OLL 33
+		"LDLLdlFLDLdf", // OLL 34
+		"LDDLLFLfLDDl", // OLL 35
+		"rdRdrDRDRfrF", // OLL 36
+		"FlfLDLdl", // OLL 37
+		"LDlDLdldlFLf", // OLL 38
+		"RfrdRDFdr", // OLL 39
+		"lFLDldfDL", // OLL 40
+		"LDlDLDDlFLDldf", // OLL 41
+		"ldLdlDDLFLDldf", // OLL 42
+		"fdrDRF", // OLL 43
+		"FDLdlf", // OLL 44
+		"FLDldf", // OLL 45
+		"ldlFLfDL", // OLL 46
+		"ldlFLflFLfDL", // OLL 47
+		"FLDldLDldf", // OLL 48
+		"RfRRBRRFRRbR", // OLL 49
+		"rBRRfRRbRRFr", // OLL 50
+		"FDLdlDLdlf", // OLL 51
+		"LDlDLdBdbl", // OLL 52
+		"rbLblBLblBBR", // OLL 53
+		"RFlFLflFLFFr", // OLL 54
+		"lFLDLdLLfLLdlDLDl", // OLL 55
+		"rbRdlDLdlDLrBR", // OLL 56
+		"LDldlRFLfr" // OLL 57
+	};
+
+	static const int PLL_COUNT = 21;
+	static const char* const PLL_CASES[PLL_COUNT] = {
+		"lFlBBLflBBLL", // Aa
+		"LLBBLFlBBLfL", // Ab
+		"LblFLBlfLBlFLblf", // E
+		"ldfLDldlFLLdldLDlDL", // F
+		"LLDlDldLdLLdUlDLu", // Ga
+		"ldLDuLLDlDLdLdLLU", // Gb
+		"LLdLdLDlDLLDuLdlU", // Gc
+		"LDldULLdLdlDlDLLu", // Gd
+		"LLRRULLRRDDLLRRULLRR", // H
+		"lDrDDLdlDDLR", // Ja
+		"LDlfLDldlFLLdl", // Jb
+		"LDlDLDlfLDldlFLLdlDDLdl", // Na
+		"lDLdlfdFLDlFlfLdL", // Nb
+		"LdldLDLUldLulDDl", // Ra
+		"LLFLDLdlfLDDlDDL", // Rb
+		"LDldlFLLdldLDlf", // T
+		"LdLDLDLdldLL", // Ua
+		"LLDLDldldlDl", // Ub
+		"lDldblBBdbDbLBL", // V
+		"FLdldLDlfLDldlFLf", // Y
+		"lRFLLRRBLLRRFlRUULLRR" // Z
+	};
+
+	// turns of the cross search: each face clockwise, counterclockwise and twice
+	static const char* const CROSS_MOVES[18] = {
+		"R", "r", "RR", "L", "l", "LL", "U", "u", "UU", "D", "d", "DD", "F", "f", "FF", "B", "b", "BB"
+	};
+
+	// D turns by count, and their length in quarter turns
+	static const char* const D_TURNS[4] = { "", "D", "DD", "d" };
+	static const int D_TURN_COST[4] = { 0, 1, 2, 1 };
+
+	static string invertSequence(const string& sec) {
+		string inverse(sec.rbegin(), sec.rend());
+		for (unsigned int i = 0; i < inverse.size(); ++i)
+			inverse[i] = isupper(inverse[i]) ? tolower(inverse[i]) : toupper(inverse[i]);
+		return inverse;
+	}
+	// the same algorithm for slot, turning F R B L into SLOT_FACES[slot]
+	static string slotSequence(const string& sec, const int& slot) {
+		const char* const faces = SLOT_FACES[0];
+		string turned(sec);
+		for (unsigned int i = 0; i < turned.size(); ++i) {
+			const char* face = strchr(faces, toupper(turned[i]));
+			if (face != NULL) {
+				char to = SLOT_FACES[slot][face - faces];
+				turned[i] = isupper(turned[i]) ? to : tolower(to);
+			}
+		}
+		return turned;
+	}
+	static bool samePiece(const Edge& a, const Edge& b) {
+		return (a.up == b.up && a.down == b.down) || (a.up == b.down && a.down == b.up);
+	}
+	static bool samePiece(const Corner& a, const Corner& b) {
+		return (a.up == b.up || a.up == b.left || a.up == b.right) &&
+			(a.left == b.up || a.left == b.left || a.left == b.right) &&
+			(a.right == b.up || a.right == b.left || a.right == b.right);
+	}
+	// rank of a permutation of 4 elements, in [0, 24)
+	static int permutationRank(const int* p) {
+		static const int factorial[4] = { 6, 2, 1, 0 };
+		int rank = 0;
+		for (int i = 0; i < 3; ++i) {
+			int smaller = 0;
+			for (int j = i + 1; j < 4; ++j)
+				if (p[j] < p[i])
+					++smaller;
+			rank += smaller * factorial[i];
+		}
+		return rank;
+	}
+
+	/**
+	 * @struct Rubik::CfopTables
+	 * @brief Case of each pattern code, found by undoing every algorithm on a solved cube
+	 *  (and turning D before and after it), so recognition is a single lookup.
+	 *
+	 */
+	struct Rubik::CfopTables {
+		static const int OLL_CODES = 81 * 16;
+		static const int PLL_CODES = 24 * 24;
+		static const int F2L_CODES = 24 * 24;
+		static const int CROSS_CODES = 24 * 24 * 24 * 24;
+
+		/**
+		 * @brief Algorithm of a case and the D turns to do before and after it
+		 * \note known without algorithm: only D turns are needed
+		 *
+		 */
+		struct Case {
+			bool known = false;
+			signed char algorithm = -1;
+			char before = 0, after = 0;
+		};
+		Case oll[OLL_CODES];
+		Case pll[PLL_CODES];
+		Case f2l[4][F2L_CODES];
+		string pairs[4][F2L_COUNT];
+		int solvedPair[4];
+		// moves from each placement of the four top edges to the cross (at most 8), a nibble each
+		DistanceTable<4> crossDistance;
+		// where each CROSS_MOVES turn takes an edge: position * 2 + flip
+		int edgeMove[18][24];
+
+		CfopTables() {
+			vector<char> scratch;
+			Rubik solved;
+			buildCross();
+			for (int slot = 0; slot < 4; ++slot) {
+				solvedPair[slot] = solved.pairCase(slot);
+				for (int i = 0; i < F2L_COUNT; ++i) {
+					pairs[slot][i] = slotSequence(F2L_CASES[i], slot);
+					Rubik rubik;
+					rubik.sequence(invertSequence(pairs[slot][i]), scratch);
+					for (int turns = 0; turns < 4; ++turns, rubik.D(scratch))
+						add(f2l[slot][rubik.pairCase(slot)], i, (4 - turns) % 4, 0);
+				}
+			}
+			for (int turns = 0; turns < 4; ++turns) {
+				add(oll[solved.lastLayerOrientation()], -1, 0, 0);
+				add(pll[solved.lastLayerPermutation()], -1, 0, (4 - turns) % 4);
+				solved.D(scratch);
+			}
+			for (int i = 0; i < OLL_COUNT; ++i) {
+				Rubik rubik;
+				rubik.sequence(invertSequence(OLL_CASES[i]), scratch);
+				for (int turns = 0; turns < 4; ++turns, rubik.D(scratch))
+					add(oll[rubik.lastLayerOrientation()], i, (4 - turns) % 4, 0);
+			}
+			for (int i = 0; i < PLL_COUNT; ++i) {
+				for (int after = 0; after < 4; ++after) {
+					Rubik rubik;
+					rubik.sequence(string(D_TURNS[after]) + invertSequence(PLL_CASES[i]), scratch);
+					for (int turns = 0; turns < 4; ++turns, rubik.D(scratch))
+						add(pll[rubik.lastLayerPermutation()], i, (4 - turns) % 4, (4 - after) % 4);
+				}
+			}
+		}
+
+		// breadth-first search from the solved cross over all the placements of its edges
+		void buildCross() {
+			vector<char> scratch;
+			for (int m = 0; m < 18; ++m) {
+				Rubik labelled;
+				for (int i = 0; i < 12; ++i)
+					labelled.edge[i] = { (char)('a' + i), (char)('A' + i) };
+				labelled.sequence(CROSS_MOVES[m], scratch);
+				for (int j = 0; j < 12; ++j) {
+					bool flipped = isupper(labelled.edge[j].up);
+					int from = tolower(labelled.edge[j].up) - 'a';
+					edgeMove[m][from * 2] = j * 2 + (flipped ? 1 : 0);
+					edgeMove[m][from * 2 + 1] = j * 2 + (flipped ? 0 : 1);
+				}
+			}
+			crossDistance.build(CROSS_CODES, vector<unsigned int>(1, crossCode(0, 2, 4, 6)), 18,
+				[this](unsigned int code, int m) { return (unsigned int)crossMove(code, m); });
+		}
+		static int crossCode(const int& a, const int& b, const int& c, const int& d) {
+			return ((a * 24 + b) * 24 + c) * 24 + d;
+		}
+		int crossMove(const int& code, const int& m) const {
+			return crossCode(edgeMove[m][code / 13824], edgeMove[m][code / 576 % 24],
+				edgeMove[m][code / 24 % 24], edgeMove[m][code % 24]);
+		}
+
+		// keeps the case with fewer D turns
+		static void add(Case& c, const int& algorithm, const int& before, const int& after) {
+			if (c.known && D_TURN_COST[(int)c.before] + D_TURN_COST[(int)c.after] <=
+				D_TURN_COST[before] + D_TURN_COST[after])
+				return;
+			c.known = true;
+			c.algorithm = algorithm;
+			c.before = before;
+			c.after = after;
+		}
+	};
+
+	const Rubik::CfopTables& Rubik::cfopTables() {
+		static const CfopTables tables;
+		return tables;
+	}
+
+	int Rubik::pairCase(const int& slot) const {
+		static const Rubik solved;
+		const Corner target = solved.corner[SLOT_CORNER[slot]];
+		const Edge targetEdge = solved.edge[SLOT_EDGE[slot]];
+		int i = searchCorner(target.up, target.left, target.right);
+		int j = searchEdge(targetEdge.up, targetEdge.down);
+		if (i < 0 || j < 0)
+			return -1;
+		int twist = corner[i].up == target.up ? 0 : (corner[i].left == target.up ? 1 : 2);
+		return (i * 3 + twist) * 24 + j * 2 + (edge[j].up == targetEdge.up ? 0 : 1);
+	}
+	int Rubik::crossCase() const {
+		static const Rubik solved;
+		int placement[4];
+		for (int i = 0; i < 4; ++i) {
+			int j = searchEdge(solved.edge[i].up, solved.edge[i].down);
+			if (j < 0)
+				return -1;
+			placement[i] = j * 2 + (edge[j].up == solved.edge[i].up ? 0 : 1);
+		}
+		return CfopTables::crossCode(placement[0], placement[1], placement[2], placement[3]);
+	}
+	int Rubik::lastLayerOrientation() const {
+		const char yellow = center[5].center;
+		int code = 0, weight = 1;
+		for (int i = 4; i < 8; ++i, weight *= 3)
+			code += weight * (corner[i].up == yellow ? 0 : (corner[i].left == yellow ? 1 : 2));
+		for (int i = 4; i < 8; ++i, weight *= 2)
+			if (edge[i].up != yellow)
+				code += weight;
+		return code;
+	}
+	int Rubik::lastLayerPermutation() const {
+		static const Rubik solved;
+		int corners[4] = { -1, -1, -1, -1 }, edges[4] = { -1, -1, -1, -1 };
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				if (samePiece(corner[4 + i], solved.corner[4 + j]))
+					corners[i] = j;
+				if (samePiece(edge[4 + i], solved.edge[4 + j]))
+					edges[i] = j;
+			}
+			if (corners[i] < 0 || edges[i] < 0)
+				return -1;
+		}
+		return permutationRank(corners) * 24 + permutationRank(edges);
+	}
+
+	void Rubik::shortestCross(vector<char>& solution) {
+		const CfopTables& tables = cfopTables();
+		int code = crossCase();
+		if (code < 0) {
+			LOG_WARN("Edges of top face not found, check the colours");
+			return;
+		}
+		// each step takes a turn one move closer to the cross
+		while (tables.crossDistance.get(code) > 0 && nextIteration()) {
+			const int lower = tables.crossDistance.get(code) - 1;
+			int m = 0;
+			while (m < 18 && tables.crossDistance.get(tables.crossMove(code, m)) != lower)
+				++m;
+			code = tables.crossMove(code, m);
+			sequence(CROSS_MOVES[m], solution);
+		}
+	}
+	void Rubik::firstTwoLayers(vector<char>& solution) {
+		const CfopTables& tables = cfopTables();
+		// every round inserts a pair, or takes a piece stuck in a wrong slot out to the bottom layer
+		for (int round = 0; round < 12 && nextIteration(); ++round) {
+			int best = -1;
+			unsigned int bestLength = 0;
+			string insertion;
+			bool pending = false;
+			for (int slot = 0; slot < 4; ++slot) {
+				int code = pairCase(slot);
+				if (code < 0) {
+					LOG_WARN("Pieces of slot " << slot << " not found, check the colours");
+					return;
+				}
+				if (code == tables.solvedPair[slot])
+					continue;
+				pending = true;
+				const CfopTables::Case& c = tables.f2l[slot][code];
+				if (!c.known)
+					continue;
+				string sec = string(D_TURNS[(int)c.before]) + tables.pairs[slot][c.algorithm];
+				if (best < 0 || sec.size() < bestLength) {
+					best = slot;
+					bestLength = sec.size();
+					insertion = sec;
+				}
+			}
+			if (!pending)
+				return;
+			if (best >= 0) {
+				sequence(insertion, solution);
+				continue;
+			}
+			// no pair can be inserted: every unsolved one has a piece in another slot
+			int stuck = -1;
+			for (int slot = 0; slot < 4 && stuck < 0; ++slot) {
+				int code = pairCase(slot);
+				int cornerSlot = code / 72, edgeSlot = (code % 24) / 2;
+				for (int other = 0; other < 4; ++other) {
+					if (other != slot && (SLOT_CORNER[other] == cornerSlot || SLOT_EDGE[other] == edgeSlot)) {
+						stuck = other;
+						break;
+					}
+				}
+			}
+			if (stuck < 0)
+				break;
+			sequence(slotSequence(F2L_EXTRACT, stuck), solution);
+		}
+		LOG_WARN("First two layers not finished");
+	}
+	void Rubik::lastLayer(vector<char>& solution) {
+		orientLastLayer(solution);
+		permuteLastLayer(solution);
+	}
+	void Rubik::orientLastLayer(vector<char>& solution) {
+		int code = lastLayerOrientation();
+		const CfopTables::Case& c = cfopTables().oll[code];
+		if (!c.known) {
+			LOG_WARN("This Rubik's cube has no solution, twisted corner or flipped edge in the last layer (" << code << ")");
+			return;
+		}
+		if (c.algorithm >= 0)
+			sequence(string(D_TURNS[(int)c.before]) + OLL_CASES[c.algorithm], solution);
+	}
+	void Rubik::permuteLastLayer(vector<char>& solution) {
+		int code = lastLayerPermutation();
+		if (code < 0 || !cfopTables().pll[code].known) {
+			LOG_WARN("This Rubik's cube has no solution, two pieces of the last layer are swapped (" << code << ")");
+			return;
+		}
+		const CfopTables::Case& c = cfopTables().pll[code];
+		string sec(D_TURNS[(int)c.before]);
+		if (c.algorithm >= 0)
+			sec += PLL_CASES[c.algorithm];
+		sequence(sec + D_TURNS[(int)c.after], solution);
+	}
+
+
+	// Fewest turns search
+	bool Rubik::twoPhaseSearch(vector<int>& moves, SearchStats& stats) {
+		Cubies cubies;
+		if (!nextIteration() || !pieces(cubies).solvable())
+			return false;
+		SearchLimits limits;
+		if (run != nullptr) {
+			// a tenth of the budget is left to finish the stage
+			limits.deadline = run->deadline - chrono::duration_cast<chrono::steady_clock::duration>(
+				chrono::duration<double, milli>(run->budget->milliseconds / 10));
+			limits.cancel = &run->progress->cancel;
+		}
+		else
+			limits.deadline = chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(
+				chrono::duration<double, milli>(SolveBudget().milliseconds));
+		if (TwoPhase::solve(cubies, moves, limits, stats))
+			return true;
+		if (run != nullptr)
+			run->stopped = true;
+		return false;
+	}
+	void Rubik::searchTurns(const vector<int>& moves, const int& from, const int& to, vector<char>& solution) {
+		// in the order of MoveIndex
+		static void (Rubik::*const turns[MOVE_COUNT])(vector<char>&) = {
+			&Rubik::U, &Rubik::U2, &Rubik::u, &Rubik::F, &Rubik::F2, &Rubik::f,
+			&Rubik::R, &Rubik::R2, &Rubik::r, &Rubik::B, &Rubik::B2, &Rubik::b,
+			&Rubik::L, &Rubik::L2, &Rubik::l, &Rubik::D, &Rubik::D2, &Rubik::d
+		};
+		for (int i = from; i < to; ++i)
+			(this->*turns[moves[i]])(solution);
+	}
+	void Rubik::searchSolution(vector<char>&) {
+		SearchSolution& found = *run->search;
+		SearchStats stats;
+		found.moves.clear();
+		if (!twoPhaseSearch(found.moves, stats))
+			return;
+		found.phase1 = stats.phase1;
+		LOG_INFO("Two-phase search: " << found.moves.size() << " turns" << (stats.optimal ? " (optimal)" : "")
+			<< ", phase 1 searched up to " << stats.depth << " turns, " << stats.nodes << " positions, "
+			<< stats.threads << " threads");
+	}
+	void Rubik::searchOrientation(vector<char>& solution) {
+		searchTurns(run->search->moves, 0, run->search->phase1, solution);
+	}
+	void Rubik::searchPermutation(vector<char>& solution) {
+		searchTurns(run->search->moves, run->search->phase1, (int)run->search->moves.size(), solution);
+	}
+
+
 	// Public interface
 	Rubik::Rubik() {
 		corner[3].up = edge[2].up = corner[2].up = edge[3].up = center[0].center = edge[1].up = 'w';
@@ -1276,6 +1712,130 @@ namespace solver {
 
 		return valid;
 	}
+	// Centers next to each position: corner fields up, left, right and edge fields up, down.
+	// The first field is always on the top or bottom face, or front or back for the middle edges.
+	// Seen from outside, up, left, right go counterclockwise on the top corners and clockwise on
+	// the bottom ones, so these list the bottom corners as up, right, left.
+	static const int CORNER_FACES[8][3] = {
+		{ 0, 4, 1 }, { 0, 1, 2 }, { 0, 2, 3 }, { 0, 3, 4 },
+		{ 5, 1, 4 }, { 5, 2, 1 }, { 5, 3, 2 }, { 5, 4, 3 }
+	};
+	static const int EDGE_FACES[12][2] = {
+		{ 0, 1 }, { 0, 2 }, { 0, 3 }, { 0, 4 },
+		{ 5, 1 }, { 5, 2 }, { 5, 3 }, { 5, 4 },
+		{ 1, 2 }, { 3, 2 }, { 3, 4 }, { 1, 4 }
+	};
+	// parity of the permutation of n elements, by its cycles
+	static int permutationParity(const int* p, const int& n) {
+		bool seen[12] = { false };
+		int parity = 0;
+		for (int i = 0; i < n; ++i) {
+			for (int j = i; !seen[j]; j = p[j]) {
+				seen[j] = true;
+				if (j != i)
+					parity ^= 1;
+			}
+		}
+		return parity;
+	}
+	Solvability Rubik::pieces(Cubies& cubies) const {
+		Solvability result;
+		// the six centers have a colour each, one bit each in pieceKey()
+		int faces = 0;
+		for (int i = 0; i < 6; ++i)
+			faces |= COLOUR_BITS.of[(unsigned char)center[i].center];
+		if (faces != 63) {
+			result.code = Solvability::WRONG_CENTERS;
+			result.reason = "There are mistakes with centers.";
+			return result;
+		}
+		// home of every piece by pieceKey() of the centers around it: a position matches its piece
+		// with one lookup, and pieces all found once have the right colours, so they aren't counted
+		signed char cornerHome[64], edgeHome[64];
+		memset(cornerHome, -1, sizeof(cornerHome));
+		memset(edgeHome, -1, sizeof(edgeHome));
+		for (int h = 0; h < 8; ++h)
+			cornerHome[pieceKey(center[CORNER_FACES[h][0]].center, center[CORNER_FACES[h][1]].center,
+				center[CORNER_FACES[h][2]].center)] = h;
+		for (int h = 0; h < 12; ++h)
+			edgeHome[pieceKey(center[EDGE_FACES[h][0]].center, center[EDGE_FACES[h][1]].center)] = h;
+
+		// home of the piece at each position, and its twist or flip there
+		bool cornerSeen[8] = { false }, edgeSeen[12] = { false };
+		for (int i = 0; i < 8; ++i) {
+			const char sticker[3] = { corner[i].up, i < 4 ? corner[i].left : corner[i].right,
+				i < 4 ? corner[i].right : corner[i].left };
+			int h = cornerHome[pieceKey(sticker[0], sticker[1], sticker[2])];
+			if (h >= 0) {
+				const char up = center[CORNER_FACES[h][0]].center;
+				int t = sticker[0] == up ? 0 : (sticker[1] == up ? 1 : 2);
+				// the same colours the other way round are a mirrored corner
+				if (sticker[(t + 1) % 3] != center[CORNER_FACES[h][1]].center)
+					h = -1;
+				cubies.twist[i] = t;
+			}
+			cubies.corner[i] = h;
+			if (h < 0 || cornerSeen[h]) {
+				if (wrongColours(result))
+					return result;
+				result.code = Solvability::UNKNOWN_PIECE;
+				result.reason = string("Corner (") + corner[i].up + "," + corner[i].left + "," + corner[i].right +
+					") in position " + to_string(i) + (h < 0 ? " doesn't exist." : " is repeated.");
+				return result;
+			}
+			cornerSeen[h] = true;
+		}
+		for (int i = 0; i < 12; ++i) {
+			int h = edgeHome[pieceKey(edge[i].up, edge[i].down)];
+			if (h >= 0)
+				cubies.flip[i] = edge[i].up == center[EDGE_FACES[h][0]].center ? 0 : 1;
+			cubies.edge[i] = h;
+			if (h < 0 || edgeSeen[h]) {
+				if (wrongColours(result))
+					return result;
+				result.code = Solvability::UNKNOWN_PIECE;
+				result.reason = string("Edge (") + edge[i].up + "," + edge[i].down + ") in position " + to_string(i) +
+					(h < 0 ? " doesn't exist." : " is repeated.");
+				return result;
+			}
+			edgeSeen[h] = true;
+		}
+		return result;
+	}
+	bool Rubik::wrongColours(Solvability& result) const {
+		result.code = logicErrors();
+		if (result.code == Solvability::WRONG_EDGES)
+			result.reason = "There are mistakes with edges.";
+		else if (result.code == Solvability::WRONG_CORNERS)
+			result.reason = "There are mistakes with corners.";
+		return !result.solvable();
+	}
+	Solvability Rubik::solvability() const {
+		Cubies cubies;
+		Solvability result = pieces(cubies);
+		if (!result.solvable())
+			return result;
+
+		int twist = 0, flip = 0;
+		for (int i = 0; i < 8; ++i)
+			twist += cubies.twist[i];
+		for (int i = 0; i < 12; ++i)
+			flip += cubies.flip[i];
+		if (twist % 3 != 0) {
+			result.code = Solvability::TWISTED_CORNER;
+			result.reason = twist % 3 == 1 ? "One corner is twisted, it needs a third of a turn clockwise." :
+				"One corner is twisted, it needs a third of a turn counterclockwise.";
+		}
+		else if (flip % 2 != 0) {
+			result.code = Solvability::FLIPPED_EDGE;
+			result.reason = "One edge is flipped.";
+		}
+		else if (permutationParity(cubies.corner, 8) != permutationParity(cubies.edge, 12)) {
+			result.code = Solvability::SWAPPED_PIECES;
+			result.reason = "Two pieces are swapped (odd permutation).";
+		}
+		return result;
+	}
 	void Rubik::correctMistakes() {
 		char letter;
 		int number;
@@ -1405,353 +1965,144 @@ namespace solver {
 			cout << "Do you want to change other colour? [y/n]\n";
 			cin >> letter;
 		} while (letter == 'y' || letter == 'Y');
+		indexed = false;
 	}
 
 	// Movements
+	// Pieces hold only chars, so the edges and the corners are 24 stickers each
+	static_assert(sizeof(Edge) == 2 && sizeof(Corner) == 3, "pieces without padding");
+	void Rubik::apply(const StickerTable& move) {
+		char before[48];
+		char* edges = reinterpret_cast<char*>(edge);
+		char* corners = reinterpret_cast<char*>(corner);
+		memcpy(before, edges, 24);
+		memcpy(before + 24, corners, 24);
+		for (int k = 0; k < 24; ++k)
+			edges[k] = before[move.from[k]];
+		for (int k = 0; k < 24; ++k)
+			corners[k] = before[move.from[24 + k]];
+		indexed = false;
+	}
+	// One piece of a turn, with where it comes from known at compile time; the pieces the turn
+	// leaves alone compile to nothing
+	static inline char field(const Corner& piece, const int& k) {
+		return k == 0 ? piece.up : (k == 1 ? piece.left : piece.right);
+	}
+	template <int MOVE, int I>
+	static inline void turnEdge(Edge* edge, const Edge* before) {
+		constexpr int from = MOVE_TABLES[MOVE].edgeFrom[I];
+		constexpr bool flip = MOVE_TABLES[MOVE].edgeFlip[I];
+		if (from != I || flip) {
+			edge[I].up = flip ? before[from].down : before[from].up;
+			edge[I].down = flip ? before[from].up : before[from].down;
+		}
+	}
+	template <int MOVE, int I>
+	static inline void turnCorner(Corner* corner, const Corner* before) {
+		constexpr int from = MOVE_TABLES[MOVE].cornerFrom[I];
+		constexpr int up = MOVE_TABLES[MOVE].cornerField[I][0];
+		constexpr int left = MOVE_TABLES[MOVE].cornerField[I][1];
+		constexpr int right = MOVE_TABLES[MOVE].cornerField[I][2];
+		if (from != I || up != 0 || left != 1) {
+			corner[I].up = field(before[from], up);
+			corner[I].left = field(before[from], left);
+			corner[I].right = field(before[from], right);
+		}
+	}
+	template <int MOVE, int... E, int... C>
+	static inline void turnPieces(Edge* edge, Corner* corner, integer_sequence<int, E...>, integer_sequence<int, C...>) {
+		const Edge edges[12] = { edge[0], edge[1], edge[2], edge[3], edge[4], edge[5],
+			edge[6], edge[7], edge[8], edge[9], edge[10], edge[11] };
+		const Corner corners[8] = { corner[0], corner[1], corner[2], corner[3],
+			corner[4], corner[5], corner[6], corner[7] };
+		const int expand[] = { (turnEdge<MOVE, E>(edge, edges), 0)..., (turnCorner<MOVE, C>(corner, corners), 0)... };
+		(void)expand;
+	}
+	template <int MOVE>
+	inline void Rubik::turn() {
+		turnPieces<MOVE>(edge, corner, make_integer_sequence<int, 12>(), make_integer_sequence<int, 8>());
+		indexed = false;
+	}
 	void Rubik::R(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[1];
-		edge[1] = edge[8];
-		edge[8] = edge[5];
-		edge[5] = edge[9];
-		edge[9] = laux;
-
-		aux.left = corner[1].right;
-		aux.right = corner[1].up;
-		aux.up = corner[1].left;
-
-		corner[1].left = corner[5].up;
-		corner[1].right = corner[5].right;
-		corner[1].up = corner[5].left;
-
-		corner[5].left = corner[6].up;
-		corner[5].right = corner[6].left;
-		corner[5].up = corner[6].right;
-
-		corner[6].left = corner[2].left;
-		corner[6].right = corner[2].up;
-		corner[6].up = corner[2].right;
-
-		corner[2] = aux;
+		turn<MOVE_R>();
 		solution.push_back('R');
 	}
 	void Rubik::R2(vector<char>& solution) {
-		R(solution);
-		R(solution);
+		turn<MOVE_R2>();
+		solution.push_back('R');
+		solution.push_back('R');
 	}
 	void Rubik::r(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[1];
-		edge[1] = edge[9];
-		edge[9] = edge[5];
-		edge[5] = edge[8];
-		edge[8] = laux;
-
-		aux.left = corner[1].up;
-		aux.right = corner[1].right;
-		aux.up = corner[1].left;
-
-		corner[1].left = corner[2].up;
-		corner[1].right = corner[2].left;
-		corner[1].up = corner[2].right;
-
-		corner[2].left = corner[6].left;
-		corner[2].right = corner[6].up;
-		corner[2].up = corner[6].right;
-
-		corner[6].left = corner[5].right;
-		corner[6].right = corner[5].up;
-		corner[6].up = corner[5].left;
-
-		corner[5] = aux;
+		turn<MOVE_r>();
 		solution.push_back('r');
 	}
 	void Rubik::L(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[3];
-		edge[3] = edge[10];
-		edge[10] = edge[7];
-		edge[7] = edge[11];
-		edge[11] = laux;
-
-		aux.left = corner[0].left;
-		aux.right = corner[0].up;
-		aux.up = corner[0].right;
-
-		corner[0].left = corner[3].right;
-		corner[0].right = corner[3].up;
-		corner[0].up = corner[3].left;
-
-		corner[3].left = corner[7].up;
-		corner[3].right = corner[7].right;
-		corner[3].up = corner[7].left;
-
-		corner[7].left = corner[4].up;
-		corner[7].right = corner[4].left;
-		corner[7].up = corner[4].right;
-
-		corner[4] = aux;
+		turn<MOVE_L>();
 		solution.push_back('L');
 	}
 	void Rubik::L2(vector<char>& solution) {
-		L(solution);
-		L(solution);
+		turn<MOVE_L2>();
+		solution.push_back('L');
+		solution.push_back('L');
 	}
 	void Rubik::l(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[3];
-		edge[3] = edge[11];
-		edge[11] = edge[7];
-		edge[7] = edge[10];
-		edge[10] = laux;
-
-		aux.left = corner[0].up;
-		aux.right = corner[0].left;
-		aux.up = corner[0].right;
-
-		corner[0].left = corner[4].left;
-		corner[0].right = corner[4].up;
-		corner[0].up = corner[4].right;
-
-		corner[4].left = corner[7].right;
-		corner[4].right = corner[7].up;
-		corner[4].up = corner[7].left;
-
-		corner[7].left = corner[3].up;
-		corner[7].right = corner[3].right;
-		corner[7].up = corner[3].left;
-
-		corner[3] = aux;
+		turn<MOVE_l>();
 		solution.push_back('l');
 	}
 	void Rubik::D(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[4];
-		edge[4] = edge[7];
-		edge[7] = edge[6];
-		edge[6] = edge[5];
-		edge[5] = laux;
-
-		aux = corner[5];
-		corner[5] = corner[4];
-		corner[4] = corner[7];
-		corner[7] = corner[6];
-		corner[6] = aux;
+		turn<MOVE_D>();
 		solution.push_back('D');
 	}
 	void Rubik::D2(vector<char>& solution) {
-		D(solution);
-		D(solution);
+		turn<MOVE_D2>();
+		solution.push_back('D');
+		solution.push_back('D');
 	}
 	void Rubik::d(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[4];
-		edge[4] = edge[5];
-		edge[5] = edge[6];
-		edge[6] = edge[7];
-		edge[7] = laux;
-
-		aux = corner[5];
-		corner[5] = corner[6];
-		corner[6] = corner[7];
-		corner[7] = corner[4];
-		corner[4] = aux;
+		turn<MOVE_d>();
 		solution.push_back('d');
 	}
 	void Rubik::U(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[0];
-		edge[0] = edge[1];
-		edge[1] = edge[2];
-		edge[2] = edge[3];
-		edge[3] = laux;
-
-		aux = corner[0];
-		corner[0] = corner[1];
-		corner[1] = corner[2];
-		corner[2] = corner[3];
-		corner[3] = aux;
+		turn<MOVE_U>();
 		solution.push_back('U');
 	}
 	void Rubik::U2(vector<char>& solution) {
-		U(solution);
-		U(solution);
+		turn<MOVE_U2>();
+		solution.push_back('U');
+		solution.push_back('U');
 	}
 	void Rubik::u(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux = edge[0];
-		edge[0] = edge[3];
-		edge[3] = edge[2];
-		edge[2] = edge[1];
-		edge[1] = laux;
-
-		aux = corner[1];
-		corner[1] = corner[0];
-		corner[0] = corner[3];
-		corner[3] = corner[2];
-		corner[2] = aux;
+		turn<MOVE_u>();
 		solution.push_back('u');
 	}
 	void Rubik::F(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux.down = edge[0].up;
-		laux.up = edge[0].down;
-		edge[0].up = edge[11].down;
-		edge[0].down = edge[11].up;
-		edge[11].up = edge[4].down;
-		edge[11].down = edge[4].up;
-		edge[4].up = edge[8].down;
-		edge[4].down = edge[8].up;
-		edge[8] = laux;
-
-		aux.left = corner[1].left;
-		aux.right = corner[1].up;
-		aux.up = corner[1].right;
-
-		corner[1].left = corner[0].right;
-		corner[1].right = corner[0].up;
-		corner[1].up = corner[0].left;
-
-		corner[0].left = corner[4].up;
-		corner[0].right = corner[4].right;
-		corner[0].up = corner[4].left;
-
-		corner[4].left = corner[5].up;
-		corner[4].right = corner[5].left;
-		corner[4].up = corner[5].right;
-
-		corner[5] = aux;
+		turn<MOVE_F>();
 		solution.push_back('F');
 	}
 	void Rubik::F2(vector<char>& solution) {
-		F(solution);
-		F(solution);
+		turn<MOVE_F2>();
+		solution.push_back('F');
+		solution.push_back('F');
 	}
 	void Rubik::f(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux.up = edge[8].down;
-		laux.down = edge[8].up;
-		edge[8].up = edge[4].down;
-		edge[8].down = edge[4].up;
-		edge[4].up = edge[11].down;
-		edge[4].down = edge[11].up;
-		edge[11].up = edge[0].down;
-		edge[11].down = edge[0].up;
-		edge[0] = laux;
-
-		aux.left = corner[1].up;
-		aux.right = corner[1].left;
-		aux.up = corner[1].right;
-
-		corner[1].left = corner[5].left;
-		corner[1].right = corner[5].up;
-		corner[1].up = corner[5].right;
-
-		corner[5].left = corner[4].right;
-		corner[5].right = corner[4].up;
-		corner[5].up = corner[4].left;
-
-		corner[4].left = corner[0].up;
-		corner[4].right = corner[0].right;
-		corner[4].up = corner[0].left;
-
-		corner[0] = aux;
+		turn<MOVE_f>();
 		solution.push_back('f');
 	}
 	void Rubik::B(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux.up = edge[9].down;
-		laux.down = edge[9].up;
-		edge[9].up = edge[6].down;
-		edge[9].down = edge[6].up;
-		edge[6].up = edge[10].down;
-		edge[6].down = edge[10].up;
-		edge[10].up = edge[2].down;
-		edge[10].down = edge[2].up;
-		edge[2] = laux;
-
-		aux.left = corner[2].right;
-		aux.right = corner[2].up;
-		aux.up = corner[2].left;
-
-		corner[2].left = corner[6].up;
-		corner[2].right = corner[6].right;
-		corner[2].up = corner[6].left;
-
-		corner[6].left = corner[7].up;
-		corner[6].right = corner[7].left;
-		corner[6].up = corner[7].right;
-
-		corner[7].left = corner[3].left;
-		corner[7].right = corner[3].up;
-		corner[7].up = corner[3].right;
-
-		corner[3] = aux;
+		turn<MOVE_B>();
 		solution.push_back('W');
 	}
 	void Rubik::B2(vector<char>& solution) {
-		B(solution);
-		B(solution);
+		turn<MOVE_B2>();
+		solution.push_back('W');
+		solution.push_back('W');
 	}
 	void Rubik::b(vector<char>& solution) {
-		Corner aux;
-		Edge laux;
-
-		laux.up = edge[10].down;
-		laux.down = edge[10].up;
-		edge[10].up = edge[6].down;
-		edge[10].down = edge[6].up;
-		edge[6].up = edge[9].down;
-		edge[6].down = edge[9].up;
-		edge[9].up = edge[2].down;
-		edge[9].down = edge[2].up;
-		edge[2] = laux;
-
-		aux.left = corner[3].up;
-		aux.right = corner[3].left;
-		aux.up = corner[3].right;
-
-		corner[3].left = corner[7].left;
-		corner[3].right = corner[7].up;
-		corner[3].up = corner[7].right;
-
-		corner[7].left = corner[6].right;
-		corner[7].right = corner[6].up;
-		corner[7].up = corner[6].left;
-
-		corner[6].left = corner[2].up;
-		corner[6].right = corner[2].right;
-		corner[6].up = corner[2].left;
-
-		corner[2] = aux;
+		turn<MOVE_b>();
 		solution.push_back('w');
 	}
 
 
-
-
 	// Solve
 	void Rubik::solveStepByStep(vector<char>& solution) {
 		unsigned int mov = 0;
@@ -1815,12 +2166,101 @@ namespace solver {
 		printf(BT_ON "\n\n\t---> ¡¡ Good job :D !! <---\n" RESET);
 	}
 	void Rubik::solve(vector<char>& solution, const char& method) {
+		SolveProgress progress;
+		solve(solution, progress, method);
+	}
+	bool Rubik::solve(vector<char>& solution, SolveProgress& progress, const char& method) {
+		return solve(solution, progress, method, SolveBudget()).success;
+	}
+	SolveResult Rubik::solve(vector<char>& solution, SolveProgress& progress, const char& method,
+		const SolveBudget& budget) {
+		SolveResult result;
 		solution.clear();
+		void (Rubik::*beginners[SolveProgress::STAGES])(vector<char>&) = {
+			&Rubik::firstStep, // White face
+			&Rubik::secondStep, // Middle step
+			&Rubik::thirdStep // Bottom face
+		};
+		void (Rubik::*cfop[SolveProgress::STAGES])(vector<char>&) = {
+			&Rubik::shortestCross, // Cross
+			&Rubik::firstTwoLayers, // F2L
+			&Rubik::lastLayer // OLL and PLL
+		};
+		void (Rubik::*search[SolveProgress::STAGES])(vector<char>&) = {
+			&Rubik::searchSolution, // Two-phase search, the cube doesn't turn
+			&Rubik::searchOrientation, // Turns of phase 1
+			&Rubik::searchPermutation // Turns of phase 2
+		};
+		static const char* beginnerNames[SolveProgress::STAGES] = { "white face", "middle layer", "yellow face" };
+		static const char* cfopNames[SolveProgress::STAGES] = { "cross", "F2L", "last layer" };
+		static const char* searchNames[SolveProgress::STAGES] = { "search", "phase 1", "phase 2" };
+		void (Rubik::**steps)(vector<char>&);
+		const char** names;
 		if (method == 'B') { // Beginners method
-			firstStep(solution); // White face
-			secondStep(solution); // Middle step
-			thirdStep(solution); // Bottom face
+			steps = beginners;
+			names = beginnerNames;
+		}
+		else if (method == 'C') { // CFOP
+			steps = cfop;
+			names = cfopNames;
+		}
+		else if (method == 'S') { // Fewest turns search
+			steps = search;
+			names = searchNames;
 		}
+		else {
+			result.reason = string("Unknown method '") + method + "'";
+			return result;
+		}
+		// The stages loop or give up silently on cubes that can't be solved
+		Solvability check = solvability();
+		if (!check.solvable()) {
+			LOG_WARN("This Rubik's cube has no solution: " << check.reason);
+			result.reason = check.reason;
+			return result;
+		}
+		// tables built once, out of the budget of the first stage, and only for a cube that can be solved
+		if (method == 'C')
+			cfopTables();
+		else if (method == 'S')
+			TwoPhase::prepare();
+		SearchSolution found; // kept between the stages of the search
+		for (int i = 0; i < SolveProgress::STAGES; ++i) {
+			StageStats& stats = result.stages[i];
+			stats.name = names[i];
+			if (progress.cancel) {
+				result.reason = "Cancelled";
+				return result;
+			}
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			StageRun stage = { &budget, &progress, &stats,
+				start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(budget.milliseconds)),
+				false, &found };
+			size_t before = solution.size();
+			run = &stage;
+			(this->*steps[i])(solution);
+			run = nullptr;
+			stats.moves = solution.size() - before;
+			stats.milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+			if (progress.cancel) {
+				result.reason = "Cancelled";
+				return result;
+			}
+			if (stage.stopped || stats.milliseconds > budget.milliseconds) {
+				result.reason = string("Stage ") + names[i] + " went over its budget (" + to_string(stats.iterations) +
+					" iterations, " + to_string((int)stats.milliseconds) + " ms)";
+				LOG_WARN(result.reason);
+				return result;
+			}
+			progress.stagesDone = i + 1;
+			result.stagesDone = i + 1;
+		}
+		result.success = isSolved();
+		if (!result.success) {
+			result.reason = "Every stage finished but the cube isn't solved";
+			LOG_WARN(result.reason);
+		}
+		return result;
 	}
 
 	void Rubik::fileExample() {
@@ -2117,20 +2557,13 @@ namespace solver {
 			readSticker(corner[6].up, is);
 		}
 		else
-			cout << "I can't read it.\n";
+			LOG_ERROR("I can't read it.");
 
-		int error = logicErrors();
-		if (error == -1) {
-			success = false;
-			cout << "There are mistakes with centers.\n";
-		}
-		else if (error == -2) {
-			success = false;
-			cout << "There are mistakes with edges.\n";
-		}
-		else if (error == -3) {
+		indexed = false;
+		Solvability check = solvability();
+		if (!check.solvable()) {
 			success = false;
-			cout << "There are mistakes with corners.\n";
+			LOG_WARN(check.reason);
 		}
 	}
 
@@ -2166,6 +2599,22 @@ namespace solver {
 
 		return ret;
 	}
+	void Rubik::setCenter(const int& position, const Center& piece) {
+		if (position >= 0 && position < 6)
+			center[position] = piece;
+	}
+	void Rubik::setEdge(const int& position, const Edge& piece) {
+		if (position >= 0 && position < 12) {
+			edge[position] = piece;
+			indexed = false;
+		}
+	}
+	void Rubik::setCorner(const int& position, const Corner& piece) {
+		if (position >= 0 && position < 8) {
+			corner[position] = piece;
+			indexed = false;
+		}
+	}
 	Rubik Rubik::randomRubik() {
 		Rubik rubik;
 		rubik.mixRubik();
@@ -2191,6 +2640,11 @@ namespace solver {
 				corner[i].left = rubik.getCorner(i).left;
 				corner[i].right = rubik.getCorner(i).right;
 			}
+			indexed = rubik.indexed;
+			if (indexed) {
+				memcpy(edgeAt, rubik.edgeAt, sizeof(edgeAt));
+				memcpy(cornerAt, rubik.cornerAt, sizeof(cornerAt));
+			}
 		}
 		return *this;
 	}
@@ -9,6 +9,8 @@
 #ifndef def_rubik_h
 #define def_rubik_h
 
+#include <atomic>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -16,6 +18,11 @@ using namespace std;
 
 namespace solver {
 
+    struct MoveTable; // move_table.h
+    struct StickerTable;
+    struct Cubies; // two_phase.h
+    struct SearchStats;
+
     /**
      * @struct Center
      * @brief Central sticker of a face.
@@ -43,6 +50,74 @@ namespace solver {
         char up, left, right;
     };
 
+    /**
+     * @struct Solvability
+     * @brief Whether a cube can be solved, and why not.
+     * \note Codes -1 to -3 are the ones of Rubik::logicErrors()
+     *
+     */
+    struct Solvability {
+        static const int SOLVABLE = 0;
+        static const int WRONG_CENTERS = -1;
+        static const int WRONG_EDGES = -2;
+        static const int WRONG_CORNERS = -3;
+        static const int UNKNOWN_PIECE = -4;
+        static const int TWISTED_CORNER = -5;
+        static const int FLIPPED_EDGE = -6;
+        static const int SWAPPED_PIECES = -7;
+        int code = SOLVABLE;
+        string reason;
+
+        bool solvable() const {
+            return code == SOLVABLE;
+        }
+    };
+
+    /**
+     * @struct SolveProgress
+     * @brief Shared with a thread running solve(): stages finished and cancel request.
+     *
+     */
+    struct SolveProgress {
+        static const int STAGES = 3;
+        std::atomic<int> stagesDone{0};
+        std::atomic<bool> cancel{false};
+    };
+
+    /**
+     * @struct SolveBudget
+     * @brief Limits of each stage of solve(); a stage going over them stops and the solve fails.
+     *
+     */
+    struct SolveBudget {
+        int iterations = 64; ///< rounds of the loops of a stage
+        double milliseconds = 1000.0; ///< wall time of a stage
+    };
+
+    /**
+     * @struct StageStats
+     * @brief What a stage of solve() did.
+     *
+     */
+    struct StageStats {
+        const char* name = "";
+        int moves = 0; ///< quarter turns added to the solution
+        int iterations = 0; ///< rounds of the loops
+        double milliseconds = 0.0;
+    };
+
+    /**
+     * @struct SolveResult
+     * @brief Outcome of solve(): whether it worked, where it stopped and the counters of each stage.
+     *
+     */
+    struct SolveResult {
+        bool success = false;
+        int stagesDone = 0; ///< stages finished, the failed one is stages[stagesDone]
+        StageStats stages[SolveProgress::STAGES];
+        string reason; ///< why it failed
+    };
+
 
 
     /**
@@ -74,7 +149,64 @@ namespace solver {
          */
         Corner corner[8];
 
+        /**
+         * @brief Position of every edge and corner, by pieceKey() of its colours
+         * \note -1 for pieces not in the cube. Movements only clear indexed, the next search
+         *  builds it again, so a stage doing many searches between its turns pays one pass
+         *
+         */
+        mutable signed char edgeAt[64], cornerAt[64];
+        mutable bool indexed = false;
+
+        /**
+         * @struct SearchSolution
+         * @brief Solution found by the first stage of the search, turned by the other two
+         *
+         */
+        struct SearchSolution {
+            vector<int> moves; ///< MoveIndex of every turn
+            int phase1 = 0; ///< turns of phase 1 at the start
+        };
+
+        /**
+         * @struct StageRun
+         * @brief Budget and counters of the stage solve() is running
+         *
+         */
+        struct StageRun {
+            const SolveBudget* budget;
+            SolveProgress* progress;
+            StageStats* stats;
+            std::chrono::steady_clock::time_point deadline;
+            bool stopped;
+            SearchSolution* search; ///< of the whole solve, for the stages of the search
+        };
+
+        /**
+         * @brief Stage being run by solve(), nullptr otherwise (it isn't copied)
+         *
+         */
+        StageRun* run = nullptr;
+
         // Auxiliary functions
+        /**
+          * @brief Moves the pieces as MOVE_TABLES[MOVE] says, unrolled at compile time
+          * @return void
+          * @see move_table.h
+          *
+          */
+        template <int MOVE>
+        void turn();
+
+        /**
+          * @brief Counts a round of a loop of the stage and checks its budget
+          * @return bool
+          * @retval false if the budget is spent or the solve is cancelled, the loop must stop
+          * @retval true always outside solve()
+          *
+          */
+        bool nextIteration();
+
         /**
           * @brief Develop each movement in natural language
           * @param vector<char>& solution Movements to explain, part of the real solution
@@ -103,8 +235,9 @@ namespace solver {
           * @param const char& ab
           * @return int
           * @retval [0, 11]
+          * @retval -1 edge not found
           * @pre ar && ab valid colours with centers not opposite
-          * @see Edge
+          * @see Edge, edgeAt
           *
           */
         int searchEdge(const char& ar, const char& ab) const;
@@ -116,14 +249,35 @@ namespace solver {
           * @param const char& de
           * @return int
           * @retval [0, 7]
+          * @retval -1 corner not found
           * @pre a, iz, de valid colours with center not opposite
-          * @see Corner
+          * @see Corner, cornerAt
           *
           */
         int searchCorner(const char& a, const char& iz, const char& de) const;
 
+        /**
+          * @brief Key of a piece in edgeAt and cornerAt, the same in every orientation
+          * @param const char& a
+          * @param const char& b
+          * @param const char& c 0 for edges
+          * @return int
+          * @retval [0, 64) one bit per colour
+          *
+          */
+        static int pieceKey(const char& a, const char& b, const char& c = 0);
+
+        /**
+          * @brief Builds edgeAt and cornerAt from the pieces
+          * @return void
+          *
+          */
+        void indexPieces() const;
+
         /**
           * @brief Execution of sec.size() movements in string sec
+          * \note The string is compiled once into a single table (see compileSequence()),
+          *  the cube moves in one step and every movement is appended to solution
           * @param string sec string with movements
           * @param vector<char>& solution where we will append movements from sec
           * @return void
@@ -133,6 +287,53 @@ namespace solver {
           */
         void sequence(const string& sec, vector<char>& solution);
 
+        /**
+          * @struct CompiledSequence
+          * @brief A string of movements as one table and the chars it adds to a solution
+          *
+          */
+        struct CompiledSequence;
+
+        /**
+          * @brief Table of a string of movements, built on its first use and shared by all the cubes;
+          *  a thread finds the ones it used before without a lock
+          * @param const string& sec
+          * @return const CompiledSequence&
+          *
+          */
+        static const CompiledSequence& compileSequence(const string& sec);
+
+        /**
+          * @brief Piece at every position, with its twist or flip, by the colours of the centers
+          * @param Cubies& cubies
+          * @return Solvability
+          * @retval code the one of logicErrors(), or UNKNOWN_PIECE for a piece that doesn't exist or
+          *  is repeated; twists, flips and parity aren't checked
+          * \note Each position is matched with one lookup by pieceKey(); the colours are only
+          *  counted (logicErrors()) to explain a piece that isn't found
+          * @see solvability()
+          *
+          */
+        Solvability pieces(Cubies& cubies) const;
+
+        /**
+          * @brief Code and reason of logicErrors() for the edges and corners
+          * @param Solvability& result
+          * @return bool
+          * @retval true the colours of the edges or the corners are wrong in number
+          *
+          */
+        bool wrongColours(Solvability& result) const;
+
+        /**
+          * @brief Moves the stickers as a table says
+          * @param const StickerTable& move
+          * @return void
+          * @see move_table.h
+          *
+          */
+        void apply(const StickerTable& move);
+
 
 
         // Parts of the solution
@@ -225,6 +426,157 @@ namespace solver {
           */
         void positionFinalCorners(vector<char>& solution);
 
+
+        // CFOP method
+        /**
+          * @struct CfopTables
+          * @brief Case of every F2L, OLL and PLL pattern code, defined in solver.cpp
+          *
+          */
+        struct CfopTables;
+
+        /**
+          * @brief Tables shared by all the cubes, built on first use
+          * @return const CfopTables&
+          *
+          */
+        static const CfopTables& cfopTables();
+
+        /**
+          * @brief Where the corner and the edge of a middle slot are
+          * @param const int& slot 0 front-right, 1 right-back, 2 back-left, 3 left-front
+          * @return int
+          * @retval [0, 576) (corner position * 3 + twist) * 24 + edge position * 2 + flip
+          * @retval -1 pieces not found
+          *
+          */
+        int pairCase(const int& slot) const;
+
+        /**
+          * @brief Where the four edges of top face are
+          * @return int
+          * @retval [0, 331776) position * 2 + flip of each edge, in base 24
+          * @retval -1 pieces not found
+          *
+          */
+        int crossCase() const;
+
+        /**
+          * @brief Orientation of the bottom layer
+          * @return int
+          * @retval [0, 1296) corner twists in base 3, then edge flips in base 2
+          *
+          */
+        int lastLayerOrientation() const;
+
+        /**
+          * @brief Permutation of the bottom layer
+          * @return int
+          * @retval [0, 576) rank of the corners * 24 + rank of the edges
+          * @retval -1 pieces not found
+          *
+          */
+        int lastLayerPermutation() const;
+
+        /**
+          * @brief White cross in the fewest moves, following its distance table
+          * @param vector<char>& solution
+          * @return void
+          * @see crossCase()
+          *
+          */
+        void shortestCross(vector<char>& solution);
+
+        /**
+          * @brief Corners of top face with their middle edges, one pair at a time (F2L)
+          * @param vector<char>& solution
+          * @return void
+          * @pre shortestCross()
+          * @see pairCase()
+          *
+          */
+        void firstTwoLayers(vector<char>& solution);
+
+        /**
+          * @brief Bottom face and last layer with one algorithm each (OLL, PLL)
+          * @param vector<char>& solution
+          * @return void
+          * @pre firstTwoLayers()
+          *
+          */
+        void lastLayer(vector<char>& solution);
+
+        /**
+          * @brief Bottom face, by its orientation code
+          * @param vector<char>& solution
+          * @return void
+          * @see lastLayerOrientation()
+          *
+          */
+        void orientLastLayer(vector<char>& solution);
+
+        /**
+          * @brief Last layer pieces to their place, by their permutation code
+          * @param vector<char>& solution
+          * @return void
+          * @pre orientLastLayer()
+          * @see lastLayerPermutation()
+          *
+          */
+        void permuteLastLayer(vector<char>& solution);
+
+
+        // Fewest turns search
+        /**
+          * @brief Runs TwoPhase on this cube within the budget of the stage, on every core
+          * @param vector<int>& moves MoveIndex of the solution, from the cube as it is
+          * @param SearchStats& stats
+          * @return bool
+          * @retval false no solution within the budget or cancelled, the stage is stopped
+          * @see two_phase.h
+          *
+          */
+        bool twoPhaseSearch(vector<int>& moves, SearchStats& stats);
+
+        /**
+          * @brief Turns of a solution of the search, appended to solution
+          * @param const vector<int>& moves MoveIndex of every turn
+          * @param const int& from
+          * @param const int& to
+          * @param vector<char>& solution
+          * @return void
+          *
+          */
+        void searchTurns(const vector<int>& moves, const int& from, const int& to, vector<char>& solution);
+
+        /**
+          * @brief Shortest solution found within the budget (optimal if it ends before it), kept
+          *  in run->search for the next stages; the cube doesn't turn
+          * @param vector<char>& solution
+          * @return void
+          *
+          */
+        void searchSolution(vector<char>& solution);
+
+        /**
+          * @brief Turns of phase 1 of the solution: corners and edges oriented, middle edges in
+          *  the middle ring
+          * @param vector<char>& solution
+          * @return void
+          * @pre searchSolution()
+          *
+          */
+        void searchOrientation(vector<char>& solution);
+
+        /**
+          * @brief Rest of the solution, with U, D and half turns
+          * @param vector<char>& solution
+          * @return void
+          * @pre searchOrientation()
+          *
+          */
+        void searchPermutation(vector<char>& solution);
+
     public:
         /**
           * @brief Constructor without arguments
@@ -269,6 +621,15 @@ namespace solver {
           */
         int logicErrors() const;
 
+        /**
+          * @brief Check if the cube can be solved: colours, pieces, corner twist, edge flip
+          *  and permutation parity, in constant time
+          * @return Solvability
+          * @see logicErrors()
+          *
+          */
+        Solvability solvability() const;
+
         /**
           * @brief Error modifier
           * @return void
@@ -451,6 +812,7 @@ namespace solver {
         /**
           * @brief It solves rubik cube with private auxiliary functions
           * @param vector<char>& solution
+          * @param const char& method 'B' beginners, 'C' CFOP, 'S' fewest turns search
           * @return void
           * @pre solution empty, it's modified
           * @see solveStepByStep()
@@ -458,6 +820,37 @@ namespace solver {
           */
         void solve(vector<char>& solution, const char& method = 'B');
 
+        /**
+          * @brief It solves rubik cube reporting each finished stage
+          * @param vector<char>& solution
+          * @param SolveProgress& progress
+          * @param const char& method
+          * @return bool
+          * @retval false if progress.cancel was set before the last stage, solution incomplete
+          * @retval false if the cube has no solution (see solvability()), solution empty
+          * @retval false if a stage went over the default SolveBudget
+          * @pre solution empty, it's modified
+          * @see solve()
+          *
+          */
+        bool solve(vector<char>& solution, SolveProgress& progress, const char& method = 'B');
+
+        /**
+          * @brief It solves rubik cube within a budget per stage, counting what each stage does
+          * @param vector<char>& solution
+          * @param SolveProgress& progress
+          * @param const char& method 'B' beginners, 'C' CFOP, 'S' fewest turns search
+          * @param const SolveBudget& budget
+          * @return SolveResult
+          * @retval success false if the cube has no solution, the method is unknown, a stage went over
+          *  the budget or progress.cancel was set; the reason says which
+          * @pre solution empty, it's modified
+          * @see solvability()
+          *
+          */
+        SolveResult solve(vector<char>& solution, SolveProgress& progress, const char& method,
+                          const SolveBudget& budget);
+
 
         // Input && output
 
@@ -580,6 +973,43 @@ namespace solver {
           */
         Corner getCorner(const int& position) const;
 
+        // Setters
+        /**
+          * @brief Setter of center piece
+          * \note It's modified
+          * @param const int& position
+          * @param const Center& piece
+          * @return void
+          * @pre Valid position
+          * @see Center
+          *
+          */
+        void setCenter(const int& position, const Center& piece);
+
+        /**
+          * @brief Setter of specific edge
+          * \note It's modified
+          * @param const int& position
+          * @param const Edge& piece
+          * @return void
+          * @pre Valid position
+          * @see Edge
+          *
+          */
+        void setEdge(const int& position, const Edge& piece);
+
+        /**
+          * @brief Setter of specific corner
+          * \note It's modified
+          * @param const int& position
+          * @param const Corner& piece
+          * @return void
+          * @pre Valid position
+          * @see Corner
+          *
+          */
+        void setCorner(const int& position, const Corner& piece);
+
         /**
          * @brief It creates a random rubik's cube
          * @return Rubik
@@ -1212,7 +1212,7 @@ static FILE *stbi__fopen(char const *filename, char const *mode)
     if (0 != fopen_s(&f, filename, mode))
         f = 0;
 #else
-    frontP = fopen(filename, mode);
+    f = fopen(filename, mode);
 #endif
     return f;
 }
@@ -1371,7 +1371,7 @@ STBIDEF int      stbi_is_hdr_from_file(FILE *f)
     stbi__start_file(&s, f);
     return stbi__hdr_test(&s);
 #else
-    STBI_NOTUSED(frontP);
+    STBI_NOTUSED(f);
     return 0;
 #endif
 }
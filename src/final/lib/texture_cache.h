@@ -0,0 +1,283 @@
+#ifndef RUBIK_TEXTURE_CACHE_H
+#define RUBIK_TEXTURE_CACHE_H
+
+#include <glad/glad.h>
+
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "stb_image.h"
+#include "log.h"
+
+// Textures shared by path: the image is decoded and uploaded once, every later
+// Acquire() of the same path returns the same texture object until the last
+// Release(). Storage is immutable (glTexStorage2D) when the driver has GL 4.2 or
+// ARB_texture_storage, with the internal format matching the channels of the
+// image (R8, RG8, RGB8 or RGBA8; grey images are swizzled back to grey).
+//
+// With the baked cache enabled, the first load also writes the full mip chain
+// next to the image as a KTX 1.1 file (path + ".ktx"); later runs upload it as
+// is, skipping the PNG decoding and glGenerateMipmap. The cache is used only
+// while it is newer than the image, so editing the image rebuilds it.
+class TextureCache
+{
+public:
+    bool BakedCache = true;
+
+    // texture object of path (with V flipped like stbi_set_flip_vertically_on_load), 0 if it can't be loaded
+    GLuint Acquire(const std::string& path)
+    {
+        std::map<std::string, Entry>::iterator found = entries.find(path);
+        if (found != entries.end())
+        {
+            ++found->second.references;
+            return found->second.id;
+        }
+
+        Image image;
+        std::string baked = path + ".ktx";
+        bool fromCache = BakedCache && IsNewer(baked, path) && ReadKtx(baked, image);
+        if (!fromCache && !Decode(path, image))
+            return 0;
+
+        Entry entry;
+        entry.id = Upload(image);
+        entry.width = image.width;
+        entry.height = image.height;
+        entry.channels = image.channels;
+        entries[path] = entry;
+        LOG_DEBUG("Texture " << path << " " << image.width << "x" << image.height << "x" << image.channels
+                  << (fromCache ? " loaded from " + baked : " decoded"));
+        if (BakedCache && !fromCache && !WriteKtx(baked, entry))
+            LOG_WARN("Could not write the texture cache " << baked);
+        return entry.id;
+    }
+
+    void Release(const std::string& path)
+    {
+        std::map<std::string, Entry>::iterator found = entries.find(path);
+        if (found == entries.end() || --found->second.references > 0)
+            return;
+        glDeleteTextures(1, &found->second.id);
+        entries.erase(found);
+    }
+    // deletes every texture, before the context goes away
+    void Clear()
+    {
+        for (std::map<std::string, Entry>::iterator it = entries.begin(); it != entries.end(); ++it)
+            glDeleteTextures(1, &it->second.id);
+        entries.clear();
+    }
+
+private:
+    struct Entry
+    {
+        GLuint id = 0;
+        int references = 1;
+        int width = 0, height = 0, channels = 0;
+    };
+    // levels[0] is the full image; with a single level the mips are generated on the GPU
+    struct Image
+    {
+        int width = 0, height = 0, channels = 0;
+        int alignment = 1; // of the rows in levels
+        std::vector<std::vector<unsigned char>> levels;
+    };
+
+    static GLenum Format(int channels)
+    {
+        static const GLenum formats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+        return formats[channels - 1];
+    }
+    static GLenum InternalFormat(int channels)
+    {
+        static const GLenum formats[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+        return formats[channels - 1];
+    }
+    static int Levels(int width, int height)
+    {
+        int levels = 1;
+        while ((width | height) >> levels)
+            ++levels;
+        return levels;
+    }
+    static int Size(int size, int level)
+    {
+        return size >> level > 0 ? size >> level : 1;
+    }
+    // bytes of a row padded to a multiple of 4, as in KTX and the default GL packing
+    static size_t PaddedRow(int width, int channels)
+    {
+        return ((size_t)width * channels + 3) & ~(size_t)3;
+    }
+
+    static bool IsNewer(const std::string& path, const std::string& than)
+    {
+        struct stat a, b;
+        return stat(path.c_str(), &a) == 0 && stat(than.c_str(), &b) == 0 && a.st_mtime >= b.st_mtime;
+    }
+
+    static bool Decode(const std::string& path, Image& image)
+    {
+        stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
+        unsigned char* data = stbi_load(path.c_str(), &image.width, &image.height, &image.channels, 0);
+        if (!data)
+        {
+            LOG_ERROR("Failed to load texture " << path << ": " << stbi_failure_reason());
+            return false;
+        }
+        image.levels.resize(1);
+        image.levels[0].assign(data, data + (size_t)image.width * image.height * image.channels);
+        image.alignment = 1; // stb_image packs the rows tightly
+        stbi_image_free(data);
+        return true;
+    }
+
+    static GLuint Upload(const Image& image)
+    {
+        const int levels = Levels(image.width, image.height);
+        const GLenum format = Format(image.channels);
+        GLuint id;
+        glGenTextures(1, &id);
+        glBindTexture(GL_TEXTURE_2D, id);
+        // set the texture wrapping parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        // set texture filtering parameters
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+        if (image.channels == 1)
+        {
+            const GLint grey[4] = { GL_RED, GL_RED, GL_RED, GL_ONE };
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, grey);
+        }
+        else if (image.channels == 2)
+        {
+            const GLint greyAlpha[4] = { GL_RED, GL_RED, GL_RED, GL_GREEN };
+            glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, greyAlpha);
+        }
+
+        bool immutable = false;
+#if defined(GL_VERSION_4_2) || defined(GL_ARB_texture_storage)
+#if defined(GL_VERSION_4_2)
+        immutable = immutable || GLAD_GL_VERSION_4_2;
+#endif
+#if defined(GL_ARB_texture_storage)
+        immutable = immutable || GLAD_GL_ARB_texture_storage;
+#endif
+        if (immutable)
+            glTexStorage2D(GL_TEXTURE_2D, levels, InternalFormat(image.channels), image.width, image.height);
+#endif
+        glPixelStorei(GL_UNPACK_ALIGNMENT, image.alignment);
+        for (int level = 0; level < (int)image.levels.size(); ++level)
+        {
+            int width = Size(image.width, level), height = Size(image.height, level);
+            if (immutable)
+                glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, width, height, format, GL_UNSIGNED_BYTE,
+                                image.levels[level].data());
+            else
+                glTexImage2D(GL_TEXTURE_2D, level, InternalFormat(image.channels), width, height, 0, format,
+                             GL_UNSIGNED_BYTE, image.levels[level].data());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        if (image.levels.size() == 1)
+            glGenerateMipmap(GL_TEXTURE_2D);
+        return id;
+    }
+
+    // KTX 1.1 header; only uncompressed 8 bit 2D textures with a full mip chain are written or read
+    struct KtxHeader
+    {
+        uint32_t endianness, glType, glTypeSize, glFormat, glInternalFormat, glBaseInternalFormat;
+        uint32_t pixelWidth, pixelHeight, pixelDepth, numberOfArrayElements, numberOfFaces;
+        uint32_t numberOfMipmapLevels, bytesOfKeyValueData;
+    };
+    static const unsigned char* KtxIdentifier()
+    {
+        static const unsigned char identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+        return identifier;
+    }
+
+    // reads the mip chain back from the GPU
+    static bool WriteKtx(const std::string& path, const Entry& entry)
+    {
+        FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file)
+            return false;
+        const int levels = Levels(entry.width, entry.height);
+        KtxHeader header = { 0x04030201, GL_UNSIGNED_BYTE, 1, Format(entry.channels), InternalFormat(entry.channels),
+                             Format(entry.channels), (uint32_t)entry.width, (uint32_t)entry.height, 0, 0, 1,
+                             (uint32_t)levels, 0 };
+        bool ok = std::fwrite(KtxIdentifier(), 1, 12, file) == 12 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+
+        glBindTexture(GL_TEXTURE_2D, entry.id);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        std::vector<unsigned char> level;
+        for (int i = 0; i < levels && ok; ++i)
+        {
+            int height = Size(entry.height, i);
+            uint32_t imageSize = (uint32_t)(PaddedRow(Size(entry.width, i), entry.channels) * height);
+            level.resize(imageSize);
+            glGetTexImage(GL_TEXTURE_2D, i, Format(entry.channels), GL_UNSIGNED_BYTE, level.data());
+            ok = std::fwrite(&imageSize, 4, 1, file) == 1 && std::fwrite(level.data(), 1, imageSize, file) == imageSize;
+        }
+        ok = std::fclose(file) == 0 && ok;
+        if (!ok)
+            std::remove(path.c_str()); // never leave a truncated cache behind
+        return ok;
+    }
+
+    static bool ReadKtx(const std::string& path, Image& image)
+    {
+        FILE* file = std::fopen(path.c_str(), "rb");
+        if (!file)
+            return false;
+        unsigned char identifier[12];
+        KtxHeader header;
+        bool ok = std::fread(identifier, 1, 12, file) == 12 && std::memcmp(identifier, KtxIdentifier(), 12) == 0
+                  && std::fread(&header, sizeof(header), 1, file) == 1
+                  && header.endianness == 0x04030201 && header.glType == GL_UNSIGNED_BYTE
+                  && header.pixelDepth == 0 && header.numberOfArrayElements == 0 && header.numberOfFaces == 1
+                  && header.pixelWidth > 0 && header.pixelHeight > 0 && header.bytesOfKeyValueData == 0;
+        int channels = 0;
+        for (int c = 1; ok && c <= 4; ++c)
+            if (header.glFormat == Format(c) && header.glInternalFormat == InternalFormat(c))
+                channels = c;
+        ok = ok && channels > 0 && header.numberOfMipmapLevels == (uint32_t)Levels(header.pixelWidth, header.pixelHeight);
+        if (ok)
+        {
+            image.width = header.pixelWidth;
+            image.height = header.pixelHeight;
+            image.channels = channels;
+            image.alignment = 4;
+            image.levels.resize(header.numberOfMipmapLevels);
+        }
+        for (uint32_t i = 0; ok && i < header.numberOfMipmapLevels; ++i)
+        {
+            uint32_t imageSize = 0;
+            ok = std::fread(&imageSize, 4, 1, file) == 1
+                 && imageSize == PaddedRow(Size(image.width, i), channels) * Size(image.height, i);
+            if (ok)
+            {
+                image.levels[i].resize(imageSize);
+                ok = std::fread(image.levels[i].data(), 1, imageSize, file) == imageSize;
+            }
+        }
+        std::fclose(file);
+        if (!ok)
+            LOG_WARN("Ignoring invalid texture cache " << path);
+        return ok;
+    }
+
+    std::map<std::string, Entry> entries;
+};
+
+#endif //RUBIK_TEXTURE_CACHE_H
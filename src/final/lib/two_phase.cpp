@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+#include "two_phase.h"
+#include "distance_table.h"
+#include "move_table.h"
+#include "parallel_search.h"
+#include "log.h"
+using namespace std;
+
+namespace solver {
+	const int TwoPhase::MAX_LENGTH; // passed by reference
+
+	// turns of phase 2, as MoveIndex
+	static const int PHASE2[TwoPhase::PHASE2_MOVES] = {
+		MOVE_U, MOVE_U2, MOVE_u, MOVE_D, MOVE_D2, MOVE_d, MOVE_R2, MOVE_L2, MOVE_F2, MOVE_B2
+	};
+	// phase 1 is cut in tasks this many turns deep
+	static const int SPLIT = 3;
+	// a worker looks at the clock and the cancel every this many positions
+	static const int CHECK_EVERY = 1024;
+
+	static const int OPPOSITE[6] = { 5, 3, 4, 1, 2, 0 }; // faces U F R B L D
+	static const int FACTORIAL[9] = { 1, 1, 2, 6, 24, 120, 720, 5040, 40320 };
+
+	// A turn of the face of the last one is never needed, and of two opposite faces,
+	// which commute, only the order with the lower face first is searched
+	static bool redundant(int move, int last) {
+		if (last < 0)
+			return false;
+		const int face = move / 3, previous = last / 3;
+		return face == previous || (OPPOSITE[face] == previous && face < previous);
+	}
+	static bool phase2Move(int move) {
+		return move / 3 == 0 || move / 3 == 5 || move % 3 == 1;
+	}
+
+	// field (0 up, 1 left, 2 right) of a corner position that is twist stickers clockwise from
+	// the up one: the bottom corners list their fields the other way round; it is its own inverse
+	static int fieldOf(int position, int twist) {
+		return twist == 0 ? 0 : (position < 4 ? twist : 3 - twist);
+	}
+
+	static int permutationIndex(const int* piece, int n) {
+		int index = 0;
+		for (int i = 0; i < n; ++i) {
+			int smaller = 0;
+			for (int j = i + 1; j < n; ++j)
+				smaller += piece[j] < piece[i];
+			index += smaller * FACTORIAL[n - 1 - i];
+		}
+		return index;
+	}
+	static void permutationPieces(int index, int* piece, int n) {
+		bool used[8] = {};
+		for (int i = 0; i < n; ++i) {
+			int smaller = index / FACTORIAL[n - 1 - i];
+			index %= FACTORIAL[n - 1 - i];
+			int p = 0;
+			while (used[p] || smaller > 0)
+				smaller -= !used[p++];
+			piece[i] = p;
+			used[p] = true;
+		}
+	}
+
+	// The coordinates, each 0 on the solved cube
+	static int twistIndex(const Cubies& cube) {
+		int index = 0;
+		for (int i = 0; i < 7; ++i)
+			index = index * 3 + cube.twist[i];
+		return index;
+	}
+	static int flipIndex(const Cubies& cube) {
+		int index = 0;
+		for (int i = 0; i < 11; ++i)
+			index = index * 2 + cube.flip[i];
+		return index;
+	}
+	static int binomial(int n, int k) {
+		if (k > n)
+			return 0;
+		int result = 1;
+		for (int i = 1; i <= k; ++i)
+			result = result * (n - k + i) / i;
+		return result;
+	}
+	// positions of the middle edges in the combinatorial number system, counted from the last position
+	static int sliceIndex(const Cubies& cube) {
+		int index = 0, found = 0;
+		for (int q = 0; q < 12; ++q)
+			if (cube.edge[11 - q] >= 8)
+				index += binomial(q, ++found);
+		return index;
+	}
+	static int cornerIndex(const Cubies& cube) {
+		return permutationIndex(cube.corner, 8);
+	}
+	// in phase 2 the up and down edges stay in positions 0 to 7 and the middle ones in 8 to 11
+	static int edgeIndex(const Cubies& cube) {
+		return permutationIndex(cube.edge, 8);
+	}
+	static int slicePermutationIndex(const Cubies& cube) {
+		int piece[4];
+		for (int i = 0; i < 4; ++i)
+			piece[i] = cube.edge[8 + i] - 8;
+		return permutationIndex(piece, 4);
+	}
+
+	static Cubies solvedCubies() {
+		Cubies cube = {};
+		for (int i = 0; i < 8; ++i)
+			cube.corner[i] = i;
+		for (int i = 0; i < 12; ++i)
+			cube.edge[i] = i;
+		return cube;
+	}
+
+	void TwoPhase::turn(Cubies& cube, const int& move) {
+		const MoveTable& table = MOVE_TABLES[move];
+		const Cubies before = cube;
+		for (int i = 0; i < 12; ++i) {
+			cube.edge[i] = before.edge[table.edgeFrom[i]];
+			cube.flip[i] = before.flip[table.edgeFrom[i]] ^ (table.edgeFlip[i] ? 1 : 0);
+		}
+		for (int i = 0; i < 8; ++i) {
+			const int from = table.cornerFrom[i], up = fieldOf(from, before.twist[from]);
+			int k = 0;
+			while (table.cornerField[i][k] != up)
+				++k;
+			cube.corner[i] = before.corner[from];
+			cube.twist[i] = fieldOf(i, k);
+		}
+	}
+
+	struct TwoPhase::Tables {
+		unsigned short twistMove[TWISTS][MOVES];
+		unsigned short flipMove[FLIPS][MOVES];
+		unsigned short sliceMove[SLICES][MOVES];
+		unsigned short cornerMove[CORNER_PERMUTATIONS][PHASE2_MOVES];
+		unsigned short edgeMove[EDGE_PERMUTATIONS][PHASE2_MOVES];
+		unsigned char slicePermutationMove[SLICE_PERMUTATIONS][PHASE2_MOVES];
+		// turns to the phase 2 positions, and from them to the solved cube, at least
+		DistanceTable<4> twistSlice, flipSlice, cornerSlice, edgeSlice;
+
+		int phase1(int twist, int flip, int slice) const {
+			return max(twistSlice.get(twist * SLICES + slice), flipSlice.get(flip * SLICES + slice));
+		}
+		int phase2(int corner, int edge, int slice) const {
+			return max(cornerSlice.get(corner * SLICE_PERMUTATIONS + slice),
+				edgeSlice.get(edge * SLICE_PERMUTATIONS + slice));
+		}
+
+		// each coordinate is turned on a cube that has it and the rest solved
+		Tables() {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			const Cubies solved = solvedCubies();
+			for (int index = 0; index < TWISTS; ++index) {
+				Cubies cube = solved;
+				int sum = 0;
+				for (int i = 6, rest = index; i >= 0; --i, rest /= 3)
+					sum += cube.twist[i] = rest % 3;
+				cube.twist[7] = (3 - sum % 3) % 3;
+				for (int m = 0; m < MOVES; ++m) {
+					Cubies turned = cube;
+					turn(turned, m);
+					twistMove[index][m] = (unsigned short)twistIndex(turned);
+				}
+			}
+			for (int index = 0; index < FLIPS; ++index) {
+				Cubies cube = solved;
+				int sum = 0;
+				for (int i = 10, rest = index; i >= 0; --i, rest /= 2)
+					sum += cube.flip[i] = rest % 2;
+				cube.flip[11] = sum % 2;
+				for (int m = 0; m < MOVES; ++m) {
+					Cubies turned = cube;
+					turn(turned, m);
+					flipMove[index][m] = (unsigned short)flipIndex(turned);
+				}
+			}
+			for (int mask = 0; mask < 1 << 12; ++mask) {
+				int count = 0;
+				for (int p = 0; p < 12; ++p)
+					count += mask >> p & 1;
+				if (count != 4)
+					continue;
+				Cubies cube = solved;
+				for (int p = 0, middle = 8, other = 0; p < 12; ++p)
+					cube.edge[p] = mask >> p & 1 ? middle++ : other++;
+				const int index = sliceIndex(cube);
+				for (int m = 0; m < MOVES; ++m) {
+					Cubies turned = cube;
+					turn(turned, m);
+					sliceMove[index][m] = (unsigned short)sliceIndex(turned);
+				}
+			}
+			for (int index = 0; index < CORNER_PERMUTATIONS; ++index) {
+				Cubies cube = solved, other = solved;
+				permutationPieces(index, cube.corner, 8);
+				permutationPieces(index, other.edge, 8);
+				for (int m = 0; m < PHASE2_MOVES; ++m) {
+					Cubies turned = cube;
+					turn(turned, PHASE2[m]);
+					cornerMove[index][m] = (unsigned short)cornerIndex(turned);
+					turned = other;
+					turn(turned, PHASE2[m]);
+					edgeMove[index][m] = (unsigned short)edgeIndex(turned);
+				}
+			}
+			for (int index = 0; index < SLICE_PERMUTATIONS; ++index) {
+				Cubies cube = solved;
+				permutationPieces(index, cube.edge + 8, 4);
+				for (int i = 8; i < 12; ++i)
+					cube.edge[i] += 8;
+				for (int m = 0; m < PHASE2_MOVES; ++m) {
+					Cubies turned = cube;
+					turn(turned, PHASE2[m]);
+					slicePermutationMove[index][m] = (unsigned char)slicePermutationIndex(turned);
+				}
+			}
+
+			const vector<unsigned int> origin(1, 0);
+			twistSlice.build(TWISTS * SLICES, origin, MOVES, [this](unsigned int s, int m) {
+				return (unsigned int)(twistMove[s / SLICES][m] * SLICES + sliceMove[s % SLICES][m]);
+			});
+			flipSlice.build(FLIPS * SLICES, origin, MOVES, [this](unsigned int s, int m) {
+				return (unsigned int)(flipMove[s / SLICES][m] * SLICES + sliceMove[s % SLICES][m]);
+			});
+			cornerSlice.build(CORNER_PERMUTATIONS * SLICE_PERMUTATIONS, origin, PHASE2_MOVES, [this](unsigned int s, int m) {
+				return (unsigned int)(cornerMove[s / SLICE_PERMUTATIONS][m] * SLICE_PERMUTATIONS +
+					slicePermutationMove[s % SLICE_PERMUTATIONS][m]);
+			});
+			edgeSlice.build(EDGE_PERMUTATIONS * SLICE_PERMUTATIONS, origin, PHASE2_MOVES, [this](unsigned int s, int m) {
+				return (unsigned int)(edgeMove[s / SLICE_PERMUTATIONS][m] * SLICE_PERMUTATIONS +
+					slicePermutationMove[s % SLICE_PERMUTATIONS][m]);
+			});
+			double milliseconds = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+			LOG_INFO("Two-phase tables: phase 1 up to " << max(twistSlice.depth(), flipSlice.depth()) << " turns, phase 2 up to "
+				<< max(cornerSlice.depth(), edgeSlice.depth()) << ", " << milliseconds << " ms");
+		}
+	};
+
+	const TwoPhase::Tables& TwoPhase::tables() {
+		static const Tables all;
+		return all;
+	}
+	void TwoPhase::prepare() {
+		tables();
+	}
+	size_t TwoPhase::tableBytes() {
+		const Tables& t = tables();
+		return t.twistSlice.bytes() + t.flipSlice.bytes() + t.cornerSlice.bytes() + t.edgeSlice.bytes();
+	}
+
+	/**
+	 * @struct TwoPhase::Search
+	 * @brief A search: the cube, its limits, the bound shared by the workers and the best solution
+	 *
+	 */
+	struct TwoPhase::Search {
+		// a node of phase 1 SPLIT turns deep, the root of a task
+		struct Task {
+			int twist, flip, slice, length;
+			int moves[SPLIT];
+		};
+		// what a worker keeps while it goes down a task
+		struct Worker {
+			int path[MAX_LENGTH];
+			long long nodes;
+		};
+
+		const Tables& t;
+		const Cubies& cube;
+		const SearchLimits& limits;
+		SearchBound bound;
+		int depth = 0; // of phase 1 in this round
+		mutex lock;
+		vector<int> best;
+		int bestPhase1 = 0; // turns of phase 1 in best
+		atomic<long long> nodes{ 0 };
+
+		Search(const Tables& tables, const Cubies& start, const SearchLimits& searchLimits)
+			: t(tables), cube(start), limits(searchLimits), bound(MAX_LENGTH + 1) {
+		}
+
+		bool stopped(Worker& w) {
+			if (++w.nodes % CHECK_EVERY == 0 && (chrono::steady_clock::now() > limits.deadline ||
+				(limits.cancel != nullptr && *limits.cancel)))
+				bound.stop = true;
+			return bound.stop.load(memory_order_relaxed);
+		}
+
+		// the nodes of phase 1 SPLIT turns deep (or depth, if less) that can still reach depth
+		void split(int twist, int flip, int slice, int length, int last, Task& task, vector<Task>& tasks) const {
+			if (length == min(SPLIT, depth)) {
+				task.twist = twist;
+				task.flip = flip;
+				task.slice = slice;
+				task.length = length;
+				tasks.push_back(task);
+				return;
+			}
+			for (int m = 0; m < MOVES; ++m) {
+				if (redundant(m, last))
+					continue;
+				const int nt = t.twistMove[twist][m], nf = t.flipMove[flip][m], ns = t.sliceMove[slice][m];
+				if (t.phase1(nt, nf, ns) > depth - length - 1)
+					continue;
+				task.moves[length] = m;
+				split(nt, nf, ns, length + 1, m, task, tasks);
+			}
+		}
+
+		void run(const Task& task, Worker& w) {
+			copy(task.moves, task.moves + task.length, w.path);
+			phase1(w, task.twist, task.flip, task.slice, task.length, task.length > 0 ? task.moves[task.length - 1] : -1);
+		}
+
+		void phase1(Worker& w, int twist, int flip, int slice, int length, int last) {
+			if (stopped(w))
+				return;
+			if (length == depth) {
+				// a last turn of phase 2 would make it a phase 1 found one turn shorter
+				if (twist == 0 && flip == 0 && slice == 0 && (length == 0 || !phase2Move(last)))
+					solvePhase2(w, length, last);
+				return;
+			}
+			for (int m = 0; m < MOVES; ++m) {
+				if (redundant(m, last))
+					continue;
+				const int nt = t.twistMove[twist][m], nf = t.flipMove[flip][m], ns = t.sliceMove[slice][m];
+				if (t.phase1(nt, nf, ns) > depth - length - 1)
+					continue;
+				w.path[length] = m;
+				phase1(w, nt, nf, ns, length + 1, m);
+			}
+		}
+
+		// shortest phase 2 after the phase 1 in w.path, if it beats the best solution
+		void solvePhase2(Worker& w, int length, int last) {
+			Cubies turned = cube;
+			for (int i = 0; i < length; ++i)
+				turn(turned, w.path[i]);
+			const int corner = cornerIndex(turned), edge = edgeIndex(turned), slice = slicePermutationIndex(turned);
+			for (int more = t.phase2(corner, edge, slice);
+				 length + more < min(bound.best.load(memory_order_relaxed), MAX_LENGTH + 1); ++more)
+				if (phase2(w, corner, edge, slice, length, length + more, last)) {
+					record(w, length + more);
+					return;
+				}
+		}
+
+		bool phase2(Worker& w, int corner, int edge, int slice, int length, int end, int last) {
+			if (length == end)
+				return corner == 0 && edge == 0 && slice == 0;
+			if (stopped(w))
+				return false;
+			for (int k = 0; k < PHASE2_MOVES; ++k) {
+				const int m = PHASE2[k];
+				if (redundant(m, last))
+					continue;
+				const int nc = t.cornerMove[corner][k], ne = t.edgeMove[edge][k], ns = t.slicePermutationMove[slice][k];
+				if (t.phase2(nc, ne, ns) > end - length - 1)
+					continue;
+				w.path[length] = m;
+				if (phase2(w, nc, ne, ns, length + 1, end, m))
+					return true;
+			}
+			return false;
+		}
+
+		void record(const Worker& w, int length) {
+			lock_guard<mutex> guard(lock);
+			if (bound.improve(length)) {
+				best.assign(w.path, w.path + length);
+				bestPhase1 = depth;
+			}
+			if (length <= limits.target)
+				bound.stop = true;
+		}
+	};
+
+	bool TwoPhase::solve(const Cubies& cube, vector<int>& moves, const SearchLimits& limits, SearchStats& stats) {
+		const Tables& t = tables();
+		Search search(t, cube, limits);
+		WorkStealingPool<Search::Task> pool(limits.threads);
+		stats = SearchStats();
+		stats.threads = pool.threads();
+		const int twist = twistIndex(cube), flip = flipIndex(cube), slice = sliceIndex(cube);
+		// no phase 1 is shorter than the table says, those lengths count as searched
+		stats.depth = t.phase1(twist, flip, slice) - 1;
+		for (int depth = stats.depth + 1; depth < search.bound.best && !search.bound.stop; ++depth) {
+			search.depth = depth;
+			vector<Search::Task> tasks;
+			Search::Task root = {};
+			search.split(twist, flip, slice, 0, -1, root, tasks);
+			pool.run(tasks, [&search](const Search::Task& task, int) {
+				Search::Worker w;
+				w.nodes = 0;
+				search.run(task, w);
+				search.nodes += w.nodes;
+			});
+			if (!search.bound.stop)
+				stats.depth = depth;
+		}
+		stats.nodes = search.nodes;
+		const bool cancelled = limits.cancel != nullptr && *limits.cancel;
+		if (search.bound.best > MAX_LENGTH || cancelled)
+			return false;
+		moves = search.best;
+		stats.phase1 = search.bestPhase1;
+		stats.optimal = stats.depth >= (int)moves.size() - 1;
+		return true;
+	}
+
+} // namespace solver
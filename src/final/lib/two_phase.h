@@ -0,0 +1,145 @@
+/**
+  * @file two_phase.h
+  * @brief Search for short solutions of the 3x3x3 in two phases on every core
+  *
+  */
+#ifndef def_two_phase_h
+#define def_two_phase_h
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+using namespace std;
+
+namespace solver {
+
+    /**
+     * @struct Cubies
+     * @brief Piece of every position of a 3x3x3 and how it sits there, positions and pieces
+     *  numbered like Rubik's edges and corners (a piece is the number of the position it
+     *  belongs to)
+     * \note twist: stickers a corner is turned clockwise from its up or down sticker on the up
+     *  or down face, flip: 1 if the sticker of an edge that goes up (front or back for the
+     *  middle ring) is on the other field
+     *
+     */
+    struct Cubies {
+        int corner[8], twist[8];
+        int edge[12], flip[12];
+    };
+
+    /**
+     * @struct SearchLimits
+     * @brief When a search ends besides proving its solution the shortest
+     *
+     */
+    struct SearchLimits {
+        chrono::steady_clock::time_point deadline; ///< it stops here with the best solution so far
+        const atomic<bool>* cancel = nullptr; ///< it stops when set
+        int target = 0; ///< it stops on a solution of at most these turns
+        int threads = 0; ///< 0 every core
+    };
+
+    /**
+     * @struct SearchStats
+     * @brief What a search did
+     *
+     */
+    struct SearchStats {
+        int phase1 = 0; ///< turns of phase 1 at the start of the solution
+        int depth = 0; ///< phase 1 lengths searched to the end
+        long long nodes = 0; ///< positions visited in both phases
+        int threads = 0;
+        bool optimal = false; ///< no solution is shorter than the one found
+    };
+
+    /**
+     * @class TwoPhase
+     * @brief Kociemba's two-phase algorithm: phase 1 takes the cube to the positions that the
+     *  turns U, D, R2, L2, F2 and B2 reach from the solved cube (every edge and corner oriented,
+     *  the middle edges in the middle ring), phase 2 solves it with those turns only, and
+     *  longer phase 1 solutions are tried while they can give a shorter total
+     * \note Both phases are IDA* searches bounded by the distance tables of pairs of coordinates
+     *  (corner twist and flip with the middle ring; the permutations of the corners and the other
+     *  edges with the one of the middle ring), about 2 MB in all. Phase 1 is split 3 turns deep
+     *  into tasks for a WorkStealingPool, and the length of the best solution is shared by the
+     *  workers, so every core prunes with it. When the phase 1 searched reaches the best length
+     *  minus one, no shorter solution is left (its turns, cut before its last turns of phase 2,
+     *  would be a phase 1 of that length): the solution is optimal. A half turn counts one
+     *
+     */
+    class TwoPhase {
+    public:
+        static const int TWISTS = 2187; ///< 3^7
+        static const int FLIPS = 2048; ///< 2^11
+        static const int SLICES = 495; ///< positions of the 4 middle edges, 12 choose 4
+        static const int CORNER_PERMUTATIONS = 40320; ///< 8!
+        static const int EDGE_PERMUTATIONS = 40320; ///< 8! of the up and down edges, in phase 2
+        static const int SLICE_PERMUTATIONS = 24; ///< 4! of the middle edges, in phase 2
+        static const int MOVES = 18;
+        static const int PHASE2_MOVES = 10;
+        static const int MAX_LENGTH = 30;
+
+        /**
+          * @brief Builds the tables, once for the whole program, with DistanceTable on every
+          *  core; later calls return at once
+          * @return void
+          *
+          */
+        static void prepare();
+
+        /**
+          * @brief Bytes of the distance tables
+          * @return size_t
+          *
+          */
+        static size_t tableBytes();
+
+        /**
+          * @brief Pieces of a cube after a turn
+          * @param Cubies& cube
+          * @param const int& move MoveIndex of move_table.h
+          * @return void
+          *
+          */
+        static void turn(Cubies& cube, const int& move);
+
+        /**
+          * @brief It searches the shortest solution it can find within the limits
+          * @param const Cubies& cube
+          * @param vector<int>& moves MoveIndex of every turn
+          * @param const SearchLimits& limits
+          * @param SearchStats& stats
+          * @return bool
+          * @retval false no solution before the deadline or the cancel, moves empty
+          * @pre the cube can be solved (Rubik::solvability()), moves empty, it's modified
+          *
+          */
+        static bool solve(const Cubies& cube, vector<int>& moves, const SearchLimits& limits, SearchStats& stats);
+
+    private:
+        /**
+          * @struct Tables
+          * @brief Turns of the coordinates and their distances, defined in two_phase.cpp
+          *
+          */
+        struct Tables;
+
+        /**
+          * @struct Search
+          * @brief State of a search shared by its workers, defined in two_phase.cpp
+          *
+          */
+        struct Search;
+
+        /**
+          * @brief The tables, built on the first call
+          * @return const Tables&
+          *
+          */
+        static const Tables& tables();
+    };
+
+} // namespace solver
+
+#endif
@@ -3,21 +3,44 @@
 
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
 #include <iostream>
+#include <random>
 #include <string>
-#include <queue>
+#include <thread>
 #include <vector>
 
 #include "lib/stb_image.h"
 #include "lib/shader.h"
 #include "lib/solver.h"
+#include "lib/animation.h"
+#include "lib/layers.h"
+#include "lib/cube_state.h"
+#include "lib/playback.h"
+#include "lib/logical_cube.h"
+#include "lib/snapshot.h"
+#include "lib/solve_job.h"
+#include "lib/log.h"
+#include "lib/profiler.h"
+#include "lib/gpu_timer.h"
+#include "lib/offscreen.h"
+#include "lib/frame_capture.h"
+#include "lib/texture_cache.h"
+#include "lib/puzzle_mesh.h"
+#include "lib/frustum.h"
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods);
 void mouse_callback(GLFWwindow* window, double xpos, double ypos);
 void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 void processInput(GLFWwindow* window, bool flagCambioCamara);
+std::string TextoHud(Profiler& profiler);
+void CrearGeometria(GLuint& VAO, GLuint& VBO, GLuint& EBO);
 
 
 // settings
@@ -41,32 +64,21 @@ float deltaTime = 0.0f;	// time between current frame and last frame
 float lastFrame = 0.0f;
 
 
+// texturas compartidas por ruta: cada imagen se decodifica y se sube una sola vez
+// aunque haya varios cubos, y desde la segunda ejecución se lee de su caché .ktx
+TextureCache texturas;
+
 void cargarTexturas(GLuint& textureID, std::string& texturePath)
 {
-    // generamos size cantidad ed texturas
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    // set the texture wrapping parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    // set texture filtering parameters
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    // load image, create texture and generate mipmaps
-    int width, height, nrChannels;
-    stbi_set_flip_vertically_on_load(true); // tell stb_image.h to flip loaded texture's on the y-axis.
-    unsigned char* data = stbi_load(texturePath.c_str(), &width, &height, &nrChannels, 0);
-    if (data)
-    {
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-    else
-    {
-        std::cout << "Failed to load texture" << std::endl;
+    textureID = texturas.Acquire(texturePath);
+    if (textureID == 0)
         exit(1); // force exit
-    }
-    stbi_image_free(data); // free image data
+}
+
+// nombre de cada método del solver para el log
+static const char* NombreMetodo(char metodo)
+{
+    return metodo == 'C' ? "CFOP" : (metodo == 'S' ? "two-phase search" : "beginners");
 }
 
 
@@ -112,29 +124,30 @@ static GLfloat vertices[] =
         };
 
 
+// todos los triángulos en sentido antihorario vistos desde afuera del cubo (GL_CULL_FACE)
 static GLuint indices[] =
         {
                 // UP face
                 // Triangles
-                0, 1, 3,
+                0, 3, 1,
                 0, 2, 3,
                 // offset: 6
 
                 // LEFT face
                 // Triangles
-                4, 5, 6,
+                4, 6, 5,
                 5, 6, 7,
                 // offset: 12
 
                 // FRONT face
                 // Triangles
-                8, 9, 11,
+                8, 11, 9,
                 8, 10, 11,
                 // offset: 18
 
                 // RIGHT face
                 // Triangles
-                12, 13, 15,
+                12, 15, 13,
                 12, 14, 15,
                 // offset: 24
 
@@ -184,61 +197,41 @@ class CuboUnidad
 public:
     static const int NFACES = 6;
     char colors[NFACES];
-    void chooseColor(Shader& program, GLint i){
+    // los colores laten con el tiempo
+    static float Brillo(){
         float timeValue = glfwGetTime();
-        float cmabioRango = (sin(timeValue)+cos(timeValue) / 2.0f) + 0.5f;
-
-        int vertexColorLocation = glGetUniformLocation(program.ID, "ourColorGlobal");
-        program.use();
+        return (sin(timeValue)+cos(timeValue) / 2.0f) + 0.5f;
+    }
+    glm::vec4 ColorOf(GLint i, float cmabioRango) const{
         switch (colors[i])
         {
             case 'W': // white color
-                glUniform4f(vertexColorLocation,
-                            1.0f*cmabioRango,
-                            1.0f*cmabioRango,
-                            1.0f*cmabioRango, 1.0f);
-                break;
+                return glm::vec4(1.0f*cmabioRango, 1.0f*cmabioRango, 1.0f*cmabioRango, 1.0f);
             case 'O': // orange color
-                glUniform4f(vertexColorLocation,
-                            0.972f*cmabioRango,
-                            0.470f*cmabioRango,
-                            0.227f*cmabioRango, 1.0f);
-                break;
+                return glm::vec4(0.972f*cmabioRango, 0.470f*cmabioRango, 0.227f*cmabioRango, 1.0f);
             case 'G': // green color
-                glUniform4f(vertexColorLocation,
-                            0.0f,
-                            1.0f*cmabioRango,
-                            0.0f, 1.0f);
-                break;
+                return glm::vec4(0.0f, 1.0f*cmabioRango, 0.0f, 1.0f);
             case 'R': // red color
-                glUniform4f(vertexColorLocation,
-                            1.0f*cmabioRango,
-                            0.0f,
-                            0.0f, 1.0f);
-                break;
+                return glm::vec4(1.0f*cmabioRango, 0.0f, 0.0f, 1.0f);
             case 'B': // blue color
-                glUniform4f(vertexColorLocation,
-                            0.0f,
-                            0.0f,
-                            1.0f*cmabioRango, 1.0f);
-                break;
+                return glm::vec4(0.0f, 0.0f, 1.0f*cmabioRango, 1.0f);
             case 'Y': // yellow color
-                glUniform4f(vertexColorLocation,
-                            1.0f*cmabioRango,
-                            1.0f*cmabioRango,
-                            0.0f, 1.0f);
-                break;
+                return glm::vec4(1.0f*cmabioRango, 1.0f*cmabioRango, 0.0f, 1.0f);
             default: // black color by default
-                program.setBool("fill", false); // no hay fill
-                program.setVec3("changingColor", 0.0f, 0.0f, 0.0f);
-                break;
+                return glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
         }
     }
-    glm::vec3 pos;
-    glm::mat4 model;
+    // los 6 colores van juntos en faceColors, el fragment shader elige el de cada cara
+    void setFaceColors(GLint faceColorsLocation){
+        glm::vec4 caras[NFACES];
+        float cmabioRango = Brillo();
+        for (GLint i = 0; i < NFACES; ++i)
+            caras[i] = ColorOf(i, cmabioRango);
+        glUniform4fv(faceColorsLocation, NFACES, &caras[0][0]);
+    }
+    glm::mat4 model; // transformación en reposo, se reconstruye desde el estado entero del cubo
     CuboUnidad(){
         model = glm::mat4(1.0f);
-        pos = glm::vec3(0.0f); // at the origin
         colors[0] = 'W'; // UP - White
         colors[1] = 'O'; // LEFT - Orange
         colors[2] = 'G'; // FRONT - Green
@@ -256,9 +249,8 @@ public:
 //        colors[4] = 'B'; // BACK - Blue
 //        colors[5] = 'Y'; // DOWN - Yellow
 //    }
-    CuboUnidad(glm::mat4 model_, glm::vec3 pos_){
+    CuboUnidad(glm::mat4 model_){
         model = model_;
-        pos = pos_;
         colors[0] = 'W'; // UP - White
         colors[1] = 'O'; // LEFT - Orange
         colors[2] = 'G'; // FRONT - Green
@@ -269,56 +261,38 @@ public:
     void setColor(GLint i, char c){
         colors[i] = c;
     }
-    void draw(Shader& program){
-        // ahora pintaremos cada cara del cubo con su respectivo color dependiendo del �ndice
-        program.setBool("fill", true);
-
+    // solo las caras que miran hacia afuera en el cubo armado llevan color, las interiores quedan negras;
+    // p en coordenadas dobles (ver layers.h), borde es la de las capas de afuera
+    void ColorsFromPosition(const glm::ivec3& p, int borde){
+        colors[0] = p.y == borde ? 'W' : 'N';
+        colors[1] = p.x == -borde ? 'O' : 'N';
+        colors[2] = p.z == borde ? 'G' : 'N';
+        colors[3] = p.x == borde ? 'R' : 'N';
+        colors[4] = p.z == -borde ? 'B' : 'N';
+        colors[5] = p.y == -borde ? 'Y' : 'N';
+    }
+    // una sola llamada para las 6 caras; el contorno negro lo dibuja el fragment shader
+    // (borde de outlineWidth) o, con los stickers procedurales, el borde del sticker.
+    // Devuelve las llamadas de dibujo emitidas
+    int draw(GLint faceColorsLocation){
+        setFaceColors(faceColorsLocation);
+        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, (void*)0);
+        return 1;
+    }
+    // el camino original, como referencia para el benchmark: cada cara por separado y
+    // después los contornos con GL_LINE_LOOP (glLineWidth > 1 no existe en core profile
+    // y muchos drivers lo resuelven por un camino lento)
+    int drawWithLines(Shader& program, GLint faceColorsLocation){
+        setFaceColors(faceColorsLocation);
+        program.setFloat("outlineWidth", 0.0f);
         for (GLint i = 0; i < NFACES; ++i)
-        {
-            switch (i)
-            {
-                case 0:// up face
-                    chooseColor(program, i);
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(0 * sizeof(GLuint)));
-                    break;
-                case 1:// left face
-                    chooseColor(program, i);
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(6 * sizeof(GLuint)));
-                    break;
-                case 2:// front face
-                    chooseColor(program, i);
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(12 * sizeof(GLuint)));
-                    break;
-                case 3:// right face
-                    chooseColor(program, i);
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(18 * sizeof(GLuint)));
-                    break;
-                case 4:// back face
-                    chooseColor(program, i);
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(24 * sizeof(GLuint)));
-                    break;
-                case 5:// down face
-                    chooseColor(program, i);
-                    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(30 * sizeof(GLuint)));
-                    break;
-            }
-        }
+            glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, (void*)(i * 6 * sizeof(GLuint)));
 
-        // luego dibujamos las l�neas
-        program.setBool("fill", false);
-        program.setVec3("changingColor", 0.0f, 0.0f, 0.0f);
-        // UP face
-        glDrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_INT, (void*)(36 * sizeof(GLuint)));
-        // LEFT face
-        glDrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_INT, (void*)(40 * sizeof(GLuint)));
-        // FRONT face
-        glDrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_INT, (void*)(44 * sizeof(GLuint)));
-        // RIGHT face
-        glDrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_INT, (void*)(48 * sizeof(GLuint)));
-        // BACK face
-        glDrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_INT, (void*)(52 * sizeof(GLuint)));
-        // DOWN face
-        glDrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_INT, (void*)(56 * sizeof(GLuint)));
+        // luego dibujamos las líneas, todo borde: negras
+        program.setFloat("outlineWidth", 1.0f);
+        for (GLint i = 0; i < NFACES; ++i)
+            glDrawElements(GL_LINE_LOOP, 4, GL_UNSIGNED_INT, (void*)((36 + i * 4) * sizeof(GLuint)));
+        return 2 * NFACES;
     }
 };
 // END CUBE
@@ -326,78 +300,64 @@ public:
 class CuboCompleto
 {
 public:
-    enum class STATE_ANIMATION { NONE, F, f, U, u, L, l, R, r, B, b, D, d, SOLVE };
+    // GIRO es el giro de giroPendiente, cualquier capa de cualquier tamaño (soluciones y mezclas NxN)
+    enum class STATE_ANIMATION { NONE, F, f, U, u, L, l, R, r, B, b, D, d, SOLVE,
+                                 M, m, E, e, S, s, X, x, Y, y, Z, z, GIRO };
     Shader program;
-    static const int NroCubos = 27;
+    Shader programStickers; // stickers procedurales, ver LoadStickerShaders
+    Shader programMalla; // malla única de todo el cubo, ver LoadMeshShaders
+    PuzzleMeshRenderer malla;
+    // cómo se dibuja: la malla única de todo el cubo (1 llamada por frame), o cada cubo con
+    // la textura y el contorno en el mismo shader (1 llamada por cubo), con stickers
+    // procedurales sin textura (1 llamada por cubo) o con el camino original de 6 caras y
+    // 6 GL_LINE_LOOP (12 llamadas por cubo), que queda como referencia para el benchmark.
+    // Si el modo elegido no está cargado se dibuja con CONTORNO
+    enum class MODO_DIBUJO { MALLA, CONTORNO, STICKERS, LINEAS };
+    MODO_DIBUJO modoDibujo = MODO_DIBUJO::MALLA;
+    float anchoContorno = 0.03f; // borde negro de cada cara, en unidades del cubo (lado 1)
+    long llamadasDibujo = 0; // draw calls emitidas desde el inicio
+    // descarte: GL_CULL_FACE para las caras de espaldas y, antes de dibujar, la esfera
+    // que envuelve al cubo contra el frustum, para escenas con muchos cubos
+    bool culling = true;
+    long cubosDescartados = 0; // veces que el cubo entero quedó fuera de la vista
+    int tamano = 3; // cubos por arista, de solver::CubeN::MIN_SIZE a MAX_SIZE
+    int NroCubos = 26; // solo los de la superficie: tamano^3 - (tamano - 2)^3
     std::string texturePath;
     GLuint textureID;
 
     GLuint RVAO; // associated VAO
-    CuboUnidad cubes[NroCubos]; // 9(cuadrante) * 3(nivel) = 27 cubos en total
+    std::vector<CuboUnidad> cubes;
+    CubeState estado; // posición y orientación enteras de cada cubo
+    glm::mat4 globalTransform = glm::mat4(1.0f);
+    LayerTurn giroActivo = { 0, 0, 0, '\0' }; // capa que se está girando
+    LayerTurn giroPendiente = { 0, 0, 0, '\0' }; // el de STATE_ANIMATION::GIRO
+    std::vector<int> movidos; // cubos que movió el último giro
+    float anguloActivo = 0.0f; // ángulo actual del giro activo en grados
     STATE_ANIMATION state_animation = STATE_ANIMATION::NONE;
 
     std::string cubeString;
     std::stringstream ssCubeString;
-    solver::Rubik rubikSolver;
     std::vector<char> solution;
-    std::queue<STATE_ANIMATION> solutionStates;
+    std::vector<solver::SliceTurn> solucionN; // la de solver::CubeN, para los tamaños distintos de 3
+    TurnClock turnClock; // avance de los giros en función del tiempo (deltaTime)
+
+    // línea de tiempo de la solución; guarda estados del cubo para poder saltar a cualquier movimiento
+    SolvePlayback<CubeState, LayerTurn> playback;
+    int sentidoReproduccion = 0; // +1 avanzando en la solución, -1 retrocediendo, 0 giro manual
+
+    SolveJob solveJob; // solver en segundo plano, se consulta una vez por frame
+    char metodo = 'B'; // método del solver: 'B' principiantes, 'C' CFOP, 'S' búsqueda del mínimo de giros
+
+    // lo único que lee el render: se publica una copia inmutable por frame
+    SnapshotChannel<CubeSnapshot> snapshots;
 
-    void HandleRubikMoves(char movement){
-        static bool was_last_move = false;
-        // un booleano para determinar si un movimiento fu� el �ltimo de la solucion del stack
-        if (solutionStates.empty() && !was_last_move) {
-            switch (movement)
-            {
-                case 'U':
-                    rubikSolver.U(solution);
-                    break;
-                case 'u':
-                    rubikSolver.u(solution);
-                    break;
-                case 'L':
-                    rubikSolver.L(solution);
-                    break;
-                case 'l':
-                    rubikSolver.l(solution);
-                    break;
-                case 'F':
-                    rubikSolver.F(solution);
-                    break;
-                case 'f':
-                    rubikSolver.f(solution);
-                    break;
-                case 'R':
-                    rubikSolver.R(solution);
-                    break;
-                case 'r':
-                    rubikSolver.r(solution);
-                    break;
-                case 'B':
-                    rubikSolver.B(solution);
-                    break;
-                case 'b':
-                    rubikSolver.b(solution);
-                    break;
-                case 'D':
-                    rubikSolver.D(solution);
-                    break;
-                case 'd':
-                    rubikSolver.d(solution);
-                    break;
-            }
-        }
-        if (was_last_move) was_last_move = false;
-        if (!solutionStates.empty()) {
-            solutionStates.pop();
-            if (solutionStates.empty()) was_last_move = true;
-        }
-    }
     CuboCompleto(){}
     // dos listas de strings, vertex y fragment shaders para cada cubo con su respectivo �ndice
     CuboCompleto(
             const char* vertexPath,
             const char* fragmentPath,
-            const char* texPath
+            const char* texPath,
+            int n = 3
     ){
         // no estamos resolviendo nada al inicio
         RVAO = 0; // valor por defecto del VAO
@@ -410,175 +370,169 @@ public:
 //        program.setInt("materialTexture", 0);
 
 
-        // primer nivel
-        cubes[0].pos = glm::vec3(-1, 1, -1);
-        cubes[1].pos = glm::vec3(0, 1, -1);
-        cubes[2].pos = glm::vec3(1, 1, -1);
-        cubes[3].pos = glm::vec3(-1, 1, 0);
-        cubes[4].pos = glm::vec3(0, 1, 0);
-        cubes[5].pos = glm::vec3(1, 1, 0);
-        cubes[6].pos = glm::vec3(-1, 1, 1);
-        cubes[7].pos = glm::vec3(0, 1, 1);
-        cubes[8].pos = glm::vec3(1, 1, 1);
-        // segundo nivel
-        cubes[9].pos = glm::vec3(-1, 0, -1);
-        cubes[10].pos = glm::vec3(0, 0, -1);
-        cubes[11].pos = glm::vec3(1, 0, -1);
-        cubes[12].pos = glm::vec3(-1, 0, 0);
-        // cubes[13].model = glm::vec3(0, 0, 0); omitimos el 13, porque es el centro y no lo necesitamos
-        cubes[14].pos = glm::vec3(1, 0, 0);
-        cubes[15].pos = glm::vec3(-1, 0, 1);
-        cubes[16].pos = glm::vec3(0, 0, 1);
-        cubes[17].pos = glm::vec3(1, 0, 1);
-        // tercer nivel
-        cubes[18].pos = glm::vec3(-1, -1, -1);
-        cubes[19].pos = glm::vec3(0, -1, -1);
-        cubes[20].pos = glm::vec3(1, -1, -1);
-        cubes[21].pos = glm::vec3(-1, -1, 0);
-        cubes[22].pos = glm::vec3(0, -1, 0);
-        cubes[23].pos = glm::vec3(1, -1, 0);
-        cubes[24].pos = glm::vec3(-1, -1, 1);
-        cubes[25].pos = glm::vec3(0, -1, 1);
-        cubes[26].pos = glm::vec3(1, -1, 1);
+        // cada cubo de la superficie empieza en su posición (de arriba hacia abajo) con la
+        // orientación identidad; los de adentro no se ven y no existen. El cubo entero
+        // se escala para ocupar lo mismo que el de 3x3x3
+        tamano = n;
+        estado.Reset(tamano);
+        NroCubos = estado.Cubies();
+        cubes.resize(NroCubos);
+        movidos.resize(NroCubos);
+        for (int i = 0; i < NroCubos; ++i)
+        {
+            cubes[i].model = estado.Model(i);
+            cubes[i].ColorsFromPosition(estado.position[i], tamano - 1);
+        }
+        globalTransform = glm::scale(glm::mat4(1.0f), glm::vec3(3.0f / tamano));
+    }
 
+    // camino alternativo sin textura (MODO_DIBUJO::STICKERS)
+    void LoadStickerShaders(const char* vertexPath, const char* fragmentPath){
+        programStickers.ConfShaders(vertexPath, fragmentPath);
+    }
+    // la malla solo lleva las caras que se ven con el cubo armado; las interiores van
+    // aparte y se dibujan mientras gira una capa
+    void LoadMeshShaders(const char* vertexPath, const char* fragmentPath){
+        programMalla.ConfShaders(vertexPath, fragmentPath);
+        PuzzleMeshRenderer::BindProgram(programMalla.ID);
+        PuzzleMesh datos = PuzzleMesh::Build(
+                NroCubos, CuboUnidad::NFACES, vertices, indices,
+                [this](int cubo, int cara, float* rgb) {
+                    glm::vec4 color = cubes[cubo].ColorOf(cara, 1.0f);
+                    rgb[0] = color[0];
+                    rgb[1] = color[1];
+                    rgb[2] = color[2];
+                    return cubes[cubo].colors[cara] != 'N';
+                },
+                [](int) { return false; });
+        malla.Init(datos, NroCubos);
+    }
+    void ReleaseMesh(){
+        if (malla.Ready())
+            malla.Release();
+    }
+    bool DrawModeReady(MODO_DIBUJO modo) const{
+        return (modo != MODO_DIBUJO::STICKERS || programStickers.ID != 0) &&
+               (modo != MODO_DIBUJO::MALLA || malla.Ready());
+    }
+    // MALLA -> CONTORNO -> STICKERS -> LINEAS -> MALLA, saltando los que no están cargados
+    void NextDrawMode(){
+        do
+            modoDibujo = (MODO_DIBUJO)(((int)modoDibujo + 1) % 4);
+        while (!DrawModeReady(modoDibujo));
     }
 
     void ApplyTransformation(glm::mat4 glob_trans){
         // aplicando la transformaci�n global a todos los cubos
+        globalTransform = glob_trans * globalTransform;
+    }
+    // arma la foto del frame actual a partir del estado; el giro activo se interpola
+    // con un cuaternión sobre la transformación en reposo de cada cubo de la capa
+    void Publish(){
+        glm::vec3 eje(0.0f);
+        eje[giroActivo.axis] = 1.0f;
+        glm::mat4 giro = globalTransform * glm::mat4_cast(glm::angleAxis(glm::radians(anguloActivo), eje));
+
+        CubeSnapshot foto;
+        foto.model.resize(NroCubos);
         for (int i = 0; i < NroCubos; ++i)
-            cubes[i].model = cubes[i].model * glob_trans;
+        {
+            if (anguloActivo != 0.0f && estado.InLayer(i, giroActivo))
+                foto.model[i] = giro * cubes[i].model;
+            else
+                foto.model[i] = globalTransform * cubes[i].model;
+        }
+        foto.turning = anguloActivo != 0.0f;
+        // esfera que envuelve todos los cubos (esquinas a tamano / 2 del centro en cada eje)
+        foto.center = glm::vec3(globalTransform[3][0], globalTransform[3][1], globalTransform[3][2]);
+        float escala = 0.0f;
+        for (int eje = 0; eje < 3; ++eje)
+            escala = std::max(escala, glm::length(glm::vec3(globalTransform[eje][0], globalTransform[eje][1], globalTransform[eje][2])));
+        foto.radius = 0.5f * tamano * std::sqrt(3.0f) * escala;
+        snapshots.Publish(foto);
     }
-    void DrawCube(glm::mat4& view, glm::mat4& projection){
+    void DrawCube(const CubeSnapshot& foto, glm::mat4& view, glm::mat4& projection){
+        if (culling && !Frustum(projection * view).SphereVisible(foto.center, foto.radius)) {
+            ++cubosDescartados;
+            return;
+        }
+        if (culling)
+            glEnable(GL_CULL_FACE);
+        else
+            glDisable(GL_CULL_FACE);
+
+        MODO_DIBUJO modo = DrawModeReady(modoDibujo) ? modoDibujo : MODO_DIBUJO::CONTORNO;
+        if (modo == MODO_DIBUJO::MALLA) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, textureID);
+            programMalla.use();
+            programMalla.setMat4("projection", projection);
+            programMalla.setMat4("view", view);
+            programMalla.setFloat("outlineWidth", anchoContorno);
+            programMalla.setFloat("brightness", CuboUnidad::Brillo());
+            malla.Draw(foto.model.data(), foto.turning, llamadasDibujo);
+            return;
+        }
+
         // render cube
         glBindVertexArray(RVAO);
-        //// activando la textura con su respectiva unidad de textura
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        bool stickers = modo == MODO_DIBUJO::STICKERS;
+        Shader& shader = stickers ? programStickers : program;
+        if (!stickers) {
+            //// activando la textura con su respectiva unidad de textura
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, textureID);
+        }
+
+        shader.use();
+        shader.setMat4("projection", projection);
+        shader.setMat4("view", view);
+        if (modo == MODO_DIBUJO::CONTORNO)
+            shader.setFloat("outlineWidth", anchoContorno);
+        GLint ubicacionColores = glGetUniformLocation(shader.ID, "faceColors");
 
         for (int i = 0; i < NroCubos; ++i)
         {
-            if (i == 13) continue; // no pintaremos el cubo porque es el interior
-            // al principio debemos trasaladar cada cubo a su posici�n
-            // pero luego debemos quitar tal traslaci�n para que no desaparezcan
-            // en el infinito tales cubos
-            cubes[i].model = glm::translate(cubes[i].model, cubes[i].pos);
-            program.use();
-            program.setMat4("projection", projection);
-            program.setMat4("view", view);
-            program.setMat4("model", cubes[i].model);
-
-            cubes[i].draw(program);
-
-            // aqu� quitamos la traslaci�n del cubo
-            cubes[i].model = glm::translate(cubes[i].model, -cubes[i].pos);
+            shader.setMat4("model", foto.model[i]);
+            if (modo == MODO_DIBUJO::LINEAS)
+                llamadasDibujo += cubes[i].drawWithLines(shader, ubicacionColores);
+            else
+                llamadasDibujo += cubes[i].draw(ubicacionColores);
         }
     }
-    void HandleDrawing(
-            glm::mat4& view,
-            glm::mat4& projection,
-            STATE_ANIMATION& some_state
-    ){
-        switch (some_state)
+    // avanza la animación y publica la foto del frame; no toca OpenGL
+    void Update(STATE_ANIMATION& some_state, float deltaTime){
+        // el tiempo del frame se reparte entre los giros pendientes: si un giro termina
+        // antes de agotarlo, el siguiente de la solución empieza en este mismo frame
+        turnClock.Begin(deltaTime);
+        while (turnClock.HasBudget() && some_state != STATE_ANIMATION::SOLVE)
         {
-            case STATE_ANIMATION::F:
+            if (some_state == STATE_ANIMATION::NONE)
             {
-                // EL ERROR SE ENCUENTRA EN EL �LTIMO MOVIMIENTO EJECUTADO POR EL SOLVER
-                if (F()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('F');
-                }
-                break;
-            }
-            case STATE_ANIMATION::f:
-            {
-                if (f()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('f');
-                }
-                break;
-            }
-            case STATE_ANIMATION::R:
-            {
-                if (R()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('R');
-                }
-                break;
-            }
-            case STATE_ANIMATION::r:
-            {
-                if (r()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('r');
-                }
-                break;
-            }
-            case STATE_ANIMATION::U:
-            {
-                if (U()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('U');
-                }
-                break;
-            }
-            case STATE_ANIMATION::u:
-            {
-                if (u()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('u');
-                }
-                break;
-            }
-            case STATE_ANIMATION::B:
-            {
-                if (B()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('B');
-                }
-                break;
-            }
-            case STATE_ANIMATION::b:
-            {
-                if (b()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('b');
-                }
-                break;
-            }
-            case STATE_ANIMATION::L:
-            {
-                if (L()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('L');
-                }
-                break;
-            }
-            case STATE_ANIMATION::l:
-            {
-                if (l()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('l');
-                }
-                break;
-            }
-            case STATE_ANIMATION::D:
-            {
-                if (D()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('D');
-                }
-                break;
+                if (!playback.Playing || !playback.HasNext())
+                    break;
+                giroPendiente = playback.Next();
+                some_state = STATE_ANIMATION::GIRO;
+                sentidoReproduccion = 1;
             }
-            case STATE_ANIMATION::d:
-            {
-                if (d()) {
-                    some_state = solutionStates.empty() ? STATE_ANIMATION::NONE : solutionStates.front();
-                    HandleRubikMoves('d');
-                }
-                break;
+            LayerTurn giro = TurnFor(some_state);
+            if (RotateLayer(giro)) {
+                some_state = STATE_ANIMATION::NONE;
+                if (sentidoReproduccion > 0)
+                    playback.Advanced();
+                else if (sentidoReproduccion < 0)
+                    playback.Retreated();
+                else
+                    playback.Clear(); // un giro manual deja la solución sin efecto
+                sentidoReproduccion = 0;
             }
         }
-        DrawCube(view, projection);
+        if (!playback.HasNext())
+            playback.Playing = false;
+        Publish();
+    }
+    void Draw(glm::mat4& view, glm::mat4& projection){
+        DrawCube(*snapshots.Latest(), view, projection);
     }
 
     void Solve(STATE_ANIMATION& some_state){
@@ -586,405 +540,236 @@ public:
 //        ss << rubikSolver;
 //        std::cout << "CuboUnidad form to solve: \n";
 //        std::cout << ss.str() << "\n";
-        rubikSolver.solve(solution);
-//        std::cout << "Solution: \n";
-        for (int movement = 0; movement < solution.size(); ++movement) {
-//            std::cout << solution[movement] << " ";
-            if (solution[movement] == 'F')
-                solutionStates.push(STATE_ANIMATION::F);
-            else if (solution[movement] == 'f')
-                solutionStates.push(STATE_ANIMATION::f);
-            else if (solution[movement] == 'W')
-                solutionStates.push(STATE_ANIMATION::B);
-            else if (solution[movement] == 'w')
-                solutionStates.push(STATE_ANIMATION::b);
-            else if (solution[movement] == 'R')
-                solutionStates.push(STATE_ANIMATION::R);
-            else if (solution[movement] == 'r')
-                solutionStates.push(STATE_ANIMATION::r);
-            else if (solution[movement] == 'L')
-                solutionStates.push(STATE_ANIMATION::L);
-            else if (solution[movement] == 'l')
-                solutionStates.push(STATE_ANIMATION::l);
-            else if (solution[movement] == 'U')
-                solutionStates.push(STATE_ANIMATION::U);
-            else if (solution[movement] == 'u')
-                solutionStates.push(STATE_ANIMATION::u);
-            else if (solution[movement] == 'D')
-                solutionStates.push(STATE_ANIMATION::D);
-            else if (solution[movement] == 'd')
-                solutionStates.push(STATE_ANIMATION::d);
+        // el solver corre en otro hilo sobre una vista del estado de los cubos;
+        // aquí solo se lanza el trabajo y en cada frame se revisa si ya terminó.
+        // El de 3x3x3 va por solver::Rubik, los demás tamaños por solver::CubeN
+        if (tamano != 3) {
+            SolveN(some_state);
+            return;
         }
-//        std::cout << "\n\n";
-        solution.clear();
-        // una vez contruida la soluci�n, se pone el primer estado
-        some_state = solutionStates.front();
-        solutionStates.pop(); // un pop porque ya consumimos un movimiento
-
-    }
-    void AssociateVAO(GLuint VAO){
-        RVAO = VAO;
-    }
-
-
-    //// rota el FRONT del cubo en sentido horario
-    bool F(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 z = glm::vec3(0.0f, 0.0f, 1.0f);
-        glm::mat4 I4(1.0f);
-        cubes[6].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[6].model;
-        cubes[7].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[7].model;
-        cubes[8].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[8].model;
-        cubes[15].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[15].model;
-        cubes[16].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[16].model;
-        cubes[17].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[17].model;
-        cubes[24].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[24].model;
-        cubes[25].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[25].model;
-        cubes[26].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[26].model;
-        if (angle >= 90)
+        if (!solveJob.Running())
         {
-            angle = 0.0f;
-            // ahora debemos actualizar las coordenadas y modelos de los cubos que cambian por la rotaci�n
-            CuboUnidad tmp_6 = cubes[6], tmp_7 = cubes[7], tmp_8 = cubes[8];
-            CuboUnidad tmp_15 = cubes[15], tmp_17 = cubes[17];
-            CuboUnidad tmp_24 = cubes[24], tmp_25 = cubes[25], tmp_26 = cubes[26];
-            cubes[6] = tmp_24, cubes[7] = tmp_15, cubes[8] = tmp_6;
-            cubes[15] = tmp_25, cubes[17] = tmp_7;
-            cubes[24] = tmp_26, cubes[25] = tmp_17, cubes[26] = tmp_8;
-            return true;
+            // un cubo sin solución se descarta antes de lanzar el hilo
+            solver::Rubik rubik = ToRubik(estado);
+            solver::Solvability check = rubik.solvability();
+            if (!check.solvable())
+            {
+                LOG_WARN("Cannot solve this cube: " << check.reason);
+                some_state = STATE_ANIMATION::NONE;
+                return;
+            }
+            solveJob.Start(rubik, metodo);
         }
-        return false;
-    }
-    //// rota el FRONT del cubo en sentido antihorario
-    bool f(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 z = glm::vec3(0.0f, 0.0f, 1.0f);
-        glm::mat4 I4(1.0f);
-        cubes[6].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[6].model;
-        cubes[7].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[7].model;
-        cubes[8].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[8].model;
-        cubes[15].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[15].model;
-        cubes[16].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[16].model;
-        cubes[17].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[17].model;
-        cubes[24].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[24].model;
-        cubes[25].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[25].model;
-        cubes[26].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[26].model;
-        if (angle >= 90)
+        if (!solveJob.Poll(solution))
         {
-            angle = 0.0f;
-            // ahora debemos actualizar las coordenadas y modelos de los cubos que cambian por la rotaci�n
-            CuboUnidad tmp_6 = cubes[6], tmp_7 = cubes[7], tmp_8 = cubes[8];
-            CuboUnidad tmp_15 = cubes[15], tmp_17 = cubes[17];
-            CuboUnidad tmp_24 = cubes[24], tmp_25 = cubes[25], tmp_26 = cubes[26];
-            cubes[6] = tmp_8, cubes[7] = tmp_17, cubes[8] = tmp_26;
-            cubes[15] = tmp_7, cubes[17] = tmp_25;
-            cubes[24] = tmp_6, cubes[25] = tmp_15, cubes[26] = tmp_24;
-            return true;
+            // si falla no se vuelve a lanzar en el siguiente frame
+            if (solveJob.Failed())
+            {
+                LOG_WARN("Solver failed at stage " << solveJob.Result().stagesDone + 1 << ": " << solveJob.Result().reason);
+                some_state = STATE_ANIMATION::NONE;
+            }
+            return;
         }
-        return false;
+        LOG_INFO("Solution found with " << solution.size() << " moves (" << NombreMetodo(metodo) << ")");
+        for (const solver::StageStats& etapa : solveJob.Result().stages)
+            LOG_DEBUG("  " << etapa.name << ": " << etapa.moves << " moves, " << etapa.iterations << " iterations, "
+                      << etapa.milliseconds << " ms");
+        std::vector<LayerTurn> giros;
+        for (char movimiento : solution)
+            giros.push_back(TurnFor(StateFor(movimiento)));
+        solution.clear();
+        Play(giros, some_state);
     }
-    //// rota el RIGHT del cubo en sentido horario
-    bool R(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 x = glm::vec3(1.0f, 0.0f, 0.0f);
-        glm::mat4 I4(1.0f);
-        cubes[8].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[8].model;
-        cubes[5].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[5].model;
-        cubes[2].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[2].model;
-        cubes[17].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[17].model;
-        cubes[14].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[14].model;
-        cubes[11].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[11].model;
-        cubes[26].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[26].model;
-        cubes[23].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[23].model;
-        cubes[20].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[20].model;
-        if (angle >= 90)
+    void SolveN(STATE_ANIMATION& some_state){
+        if (!solveJob.Running())
+            solveJob.Start(ToCubeN(estado), metodo);
+        if (!solveJob.Poll(solucionN))
         {
-            angle = 0.0f;
-            CuboUnidad tmp_8 = cubes[8], tmp_5 = cubes[5], tmp_2 = cubes[2];
-            CuboUnidad tmp_17 = cubes[17], tmp_11 = cubes[11];
-            CuboUnidad tmp_26 = cubes[26], tmp_23 = cubes[23], tmp_20 = cubes[20];
-            cubes[8] = tmp_26, cubes[5] = tmp_17, cubes[2] = tmp_8;
-            cubes[17] = tmp_23, cubes[11] = tmp_5;
-            cubes[26] = tmp_20, cubes[23] = tmp_11, cubes[20] = tmp_2;
-            return true;
+            if (solveJob.Failed())
+            {
+                LOG_WARN("Solver failed at stage " << solveJob.Result().stagesDone + 1 << ": " << solveJob.Result().reason);
+                some_state = STATE_ANIMATION::NONE;
+            }
+            return;
         }
-        return false;
-    }
-    //// rota el RIGHT del cubo en sentido antihorario
-    bool r(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 x = glm::vec3(1.0f, 0.0f, 0.0f);
-        glm::mat4 I4(1.0f);
-        cubes[8].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[8].model;
-        cubes[5].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[5].model;
-        cubes[2].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[2].model;
-        cubes[17].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[17].model;
-        cubes[14].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[14].model;
-        cubes[11].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[11].model;
-        cubes[26].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[26].model;
-        cubes[23].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[23].model;
-        cubes[20].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[20].model;
-        if (angle >= 90)
+        LOG_INFO("Solution found with " << solucionN.size() << " slice turns (" << tamano << "x" << tamano << "x"
+                 << tamano << ")");
+        for (const solver::StageStats& etapa : solveJob.Result().stages)
+            LOG_DEBUG("  " << etapa.name << ": " << etapa.moves << " moves, " << etapa.iterations << " iterations, "
+                      << etapa.milliseconds << " ms");
+        // un medio giro se reproduce como dos cuartos
+        std::vector<LayerTurn> giros;
+        for (const solver::SliceTurn& t : solucionN)
         {
-            angle = 0.0f;
-            CuboUnidad tmp_8 = cubes[8], tmp_5 = cubes[5], tmp_2 = cubes[2];
-            CuboUnidad tmp_17 = cubes[17], tmp_11 = cubes[11];
-            CuboUnidad tmp_26 = cubes[26], tmp_23 = cubes[23], tmp_20 = cubes[20];
-            cubes[8] = tmp_2, cubes[5] = tmp_11, cubes[2] = tmp_20;
-            cubes[17] = tmp_5, cubes[11] = tmp_23;
-            cubes[26] = tmp_8, cubes[23] = tmp_17, cubes[20] = tmp_26;
-            return true;
+            LayerTurn giro = { t.axis, t.layer, t.quarters < 0 ? -1 : 1, '\0' };
+            giros.push_back(giro);
+            if (t.quarters == 2)
+                giros.push_back(giro);
         }
-        return false;
+        solucionN.clear();
+        Play(giros, some_state);
     }
-    //// rota el UP del cubo en sentido horario
-    bool U(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 y = glm::vec3(0.0f, 1.0f, 0.0f);
-        glm::mat4 I4(1.0f);
-        cubes[0].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[0].model;
-        cubes[1].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[1].model;
-        cubes[2].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[2].model;
-        cubes[3].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[3].model;
-        cubes[4].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[4].model;
-        cubes[5].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[5].model;
-        cubes[6].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[6].model;
-        cubes[7].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[7].model;
-        cubes[8].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[8].model;
-        if (angle >= 90)
-        {
-            angle = 0.0f;
-            CuboUnidad tmp_0 = cubes[0], tmp_1 = cubes[1], tmp_2 = cubes[2];
-            CuboUnidad tmp_3 = cubes[3], tmp_5 = cubes[5];
-            CuboUnidad tmp_6 = cubes[6], tmp_7 = cubes[7], tmp_8 = cubes[8];
-            cubes[0] = tmp_6, cubes[1] = tmp_3, cubes[2] = tmp_0;
-            cubes[3] = tmp_7, cubes[5] = tmp_1;
-            cubes[6] = tmp_8, cubes[7] = tmp_5, cubes[8] = tmp_2;
-            return true;
-        }
-        return false;
+    // una vez contruida la soluci�n, empieza la reproducci�n
+    void Play(const std::vector<LayerTurn>& giros, STATE_ANIMATION& some_state){
+        playback.Load(giros, estado, ApplyInstant);
+        playback.Playing = true;
+        sentidoReproduccion = 0;
+        some_state = STATE_ANIMATION::NONE;
     }
-    //// rota el UP del cubo en sentido antihorario
-    bool u(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 y = glm::vec3(0.0f, 1.0f, 0.0f);
-        glm::mat4 I4(1.0f);
-        cubes[0].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[0].model;
-        cubes[1].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[1].model;
-        cubes[2].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[2].model;
-        cubes[3].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[3].model;
-        cubes[4].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[4].model;
-        cubes[5].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[5].model;
-        cubes[6].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[6].model;
-        cubes[7].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[7].model;
-        cubes[8].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[8].model;
-        if (angle >= 90) {
-            angle = 0.0f;
-            CuboUnidad tmp_0 = cubes[0];
-            CuboUnidad tmp_1 = cubes[1];
-            CuboUnidad tmp_2 = cubes[2];
-            CuboUnidad tmp_3 = cubes[3];
-            CuboUnidad tmp_5 = cubes[5];
-            CuboUnidad tmp_6 = cubes[6];
-            CuboUnidad tmp_7 = cubes[7];
-            CuboUnidad tmp_8 = cubes[8];
-            cubes[0] = tmp_2;
-            cubes[1] = tmp_5;
-            cubes[2] = tmp_8;
-            cubes[3] = tmp_1;
-            cubes[5] = tmp_7;
-            cubes[6] = tmp_0;
-            cubes[7] = tmp_3;
-            cubes[8] = tmp_6;
-            return true;
-        }
-        return false;
+    void CancelSolve(STATE_ANIMATION& some_state){
+        if (some_state != STATE_ANIMATION::SOLVE)
+            return;
+        solveJob.Cancel();
+        LOG_INFO("Solve cancelled");
+        some_state = STATE_ANIMATION::NONE;
     }
-    //// rota el BACK del cubo en sentido horario
-    bool B(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 z = glm::vec3(0.0f, 0.0f, -1.0f);// z negativo
-        glm::mat4 I4(1.0f);
-        cubes[2].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[2].model;
-        cubes[1].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[1].model;
-        cubes[0].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[0].model;
-        cubes[11].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[11].model;
-        cubes[10].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[10].model;
-        cubes[9].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[9].model;
-        cubes[20].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[20].model;
-        cubes[19].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[19].model;
-        cubes[18].model = glm::rotate(I4, glm::radians(-velocidad), z) * cubes[18].model;
-        if (angle >= 90)
-        {
-            angle = 0.0f;
-            CuboUnidad tmp_2 = cubes[2], tmp_1 = cubes[1], tmp_0 = cubes[0];
-            CuboUnidad tmp_11 = cubes[11], tmp_9 = cubes[9];
-            CuboUnidad tmp_20 = cubes[20], tmp_19 = cubes[19], tmp_18 = cubes[18];
-            cubes[2] = tmp_20, cubes[1] = tmp_11, cubes[0] = tmp_2;
-            cubes[11] = tmp_19, cubes[9] = tmp_1;
-            cubes[20] = tmp_18, cubes[19] = tmp_9, cubes[18] = tmp_0;
-            return true;
-        }
-        return false;
+    void AssociateVAO(GLuint VAO){
+        RVAO = VAO;
     }
-    //// rota el BACK del cubo en sentido antihorario
-    bool b(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 z = glm::vec3(0.0f, 0.0f, -1.0f); // z negativo
-        glm::mat4 I4(1.0f);
-        cubes[2].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[2].model;
-        cubes[1].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[1].model;
-        cubes[0].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[0].model;
-        cubes[11].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[11].model;
-        cubes[10].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[10].model;
-        cubes[9].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[9].model;
-        cubes[20].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[20].model;
-        cubes[19].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[19].model;
-        cubes[18].model = glm::rotate(I4, glm::radians(velocidad), z) * cubes[18].model;
-        if (angle >= 90)
+
+    // mezcla el cubo al instante con giros al azar (sin animar): las caras del solver en el
+    // de 3x3x3, cualquier capa en los demás tamaños
+    void Scramble(int movimientos, unsigned semilla){
+        static const char letras[] = "FfRrUuLlWwDd"; // B se anota como 'W' (ver StateFor)
+        std::mt19937 azar(semilla);
+        CubeState mezcla = estado;
+        for (int i = 0; i < movimientos; ++i)
         {
-            angle = 0.0f;
-            CuboUnidad tmp_2 = cubes[2], tmp_1 = cubes[1], tmp_0 = cubes[0];
-            CuboUnidad tmp_11 = cubes[11], tmp_9 = cubes[9];
-            CuboUnidad tmp_20 = cubes[20], tmp_19 = cubes[19], tmp_18 = cubes[18];
-            cubes[2] = tmp_0, cubes[1] = tmp_9, cubes[0] = tmp_18;
-            cubes[11] = tmp_1, cubes[9] = tmp_19;
-            cubes[20] = tmp_2, cubes[19] = tmp_11, cubes[18] = tmp_20;
-            return true;
+            if (tamano == 3) {
+                ApplyInstant(mezcla, TurnFor(StateFor(letras[azar() % 12])));
+                continue;
+            }
+            int eje = (int)(azar() % 3);
+            int capa = (int)(azar() % tamano);
+            LayerTurn giro = { eje, capa, azar() % 2 ? 1 : -1, '\0' };
+            ApplyInstant(mezcla, giro);
         }
-        return false;
+        playback.Clear();
+        Restore(mezcla);
     }
-    //// rota el LEFT del cubo en sentido horario
-    bool L(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 x = glm::vec3(-1.0f, 0.0f, 0.0f); // negative x
-        glm::mat4 I4(1.0f);
-        cubes[0].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[0].model;
-        cubes[3].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[3].model;
-        cubes[6].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[6].model;
-        cubes[9].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[9].model;
-        cubes[12].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[12].model;
-        cubes[15].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[15].model;
-        cubes[18].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[18].model;
-        cubes[21].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[21].model;
-        cubes[24].model = glm::rotate(I4, glm::radians(-velocidad), x) * cubes[24].model;
-        if (angle >= 90)
-        {
-            angle = 0.0f;
-            CuboUnidad tmp_0 = cubes[0], tmp_3 = cubes[3], tmp_6 = cubes[6];
-            CuboUnidad tmp_9 = cubes[9], tmp_15 = cubes[15];
-            CuboUnidad tmp_18 = cubes[18], tmp_21 = cubes[21], tmp_24 = cubes[24];
-            cubes[0] = tmp_18, cubes[3] = tmp_9, cubes[6] = tmp_0;
-            cubes[9] = tmp_21, cubes[15] = tmp_3;
-            cubes[18] = tmp_24, cubes[21] = tmp_15, cubes[24] = tmp_6;
-            return true;
-        }
-        return false;
+
+    // controles de la línea de tiempo de la solución
+    void TogglePlay(){
+        if (playback.HasNext())
+            playback.Playing = !playback.Playing;
+    }
+    void StepForward(STATE_ANIMATION& some_state){
+        if (some_state != STATE_ANIMATION::NONE || !playback.HasNext())
+            return;
+        playback.Playing = false;
+        giroPendiente = playback.Next();
+        some_state = STATE_ANIMATION::GIRO;
+        sentidoReproduccion = 1;
+    }
+    void StepBack(STATE_ANIMATION& some_state){
+        if (some_state != STATE_ANIMATION::NONE || !playback.HasPrevious())
+            return;
+        playback.Playing = false;
+        giroPendiente = Inverse(playback.Previous());
+        some_state = STATE_ANIMATION::GIRO;
+        sentidoReproduccion = -1;
     }
-    //// rota el LEFT del cubo en sentido antihorario
-    bool l(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 x = glm::vec3(-1.0f, 0.0f, 0.0f); // negative x
-        glm::mat4 I4(1.0f);
-        cubes[0].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[0].model;
-        cubes[3].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[3].model;
-        cubes[6].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[6].model;
-        cubes[9].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[9].model;
-        cubes[12].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[12].model;
-        cubes[15].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[15].model;
-        cubes[18].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[18].model;
-        cubes[21].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[21].model;
-        cubes[24].model = glm::rotate(I4, glm::radians(velocidad), x) * cubes[24].model;
-        if (angle >= 90)
+    // salta al movimiento index sin animar los intermedios
+    void Seek(long index, STATE_ANIMATION& some_state){
+        if (playback.Size() == 0 || some_state == STATE_ANIMATION::SOLVE)
+            return;
+        size_t destino = index < 0 ? 0 : (size_t)index;
+        Restore(playback.StateAt(destino));
+        playback.SetCursor(destino);
+        some_state = STATE_ANIMATION::NONE;
+        sentidoReproduccion = 0;
+    }
+    void Restore(const CubeState& e){
+        estado = e;
+        for (int i = 0; i < NroCubos; ++i)
+            cubes[i].model = estado.Model(i);
+        // el giro que estaba a medias se descarta
+        turnClock.Cancel();
+        anguloActivo = 0.0f;
+    }
+    static void ApplyInstant(CubeState& e, const LayerTurn& giro){
+        if (giro.direction != 0)
+            e.ApplyTurn(giro);
+    }
+
+    // letra del solver (B se anota como 'W') al estado de animación
+    static STATE_ANIMATION StateFor(char move){
+        switch (move)
         {
-            angle = 0.0f;
-            CuboUnidad tmp_0 = cubes[0], tmp_3 = cubes[3], tmp_6 = cubes[6];
-            CuboUnidad tmp_9 = cubes[9], tmp_15 = cubes[15];
-            CuboUnidad tmp_18 = cubes[18], tmp_21 = cubes[21], tmp_24 = cubes[24];
-            cubes[0] = tmp_6, cubes[3] = tmp_15, cubes[6] = tmp_24;
-            cubes[9] = tmp_3, cubes[15] = tmp_21;
-            cubes[18] = tmp_0, cubes[21] = tmp_9, cubes[24] = tmp_18;
-            return true;
+            case 'F': return STATE_ANIMATION::F;
+            case 'f': return STATE_ANIMATION::f;
+            case 'W': return STATE_ANIMATION::B;
+            case 'w': return STATE_ANIMATION::b;
+            case 'R': return STATE_ANIMATION::R;
+            case 'r': return STATE_ANIMATION::r;
+            case 'L': return STATE_ANIMATION::L;
+            case 'l': return STATE_ANIMATION::l;
+            case 'U': return STATE_ANIMATION::U;
+            case 'u': return STATE_ANIMATION::u;
+            case 'D': return STATE_ANIMATION::D;
+            case 'd': return STATE_ANIMATION::d;
+            default: return STATE_ANIMATION::NONE;
         }
-        return false;
     }
-    //// rota el DOWN del cubo en sentido horario
-    bool D(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 y = glm::vec3(0.0f, -1.0f, 0.0f); // y negativo
-        glm::mat4 I4(1.0f);
-        cubes[24].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[24].model;
-        cubes[25].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[25].model;
-        cubes[26].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[26].model;
-        cubes[21].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[21].model;
-        cubes[22].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[22].model;
-        cubes[23].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[23].model;
-        cubes[18].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[18].model;
-        cubes[19].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[19].model;
-        cubes[20].model = glm::rotate(I4, glm::radians(-velocidad), y) * cubes[20].model;
-        if (angle >= 90)
+    static LayerTurn Inverse(const LayerTurn& giro){
+        char letra = isupper(giro.move) ? (char)tolower(giro.move) : (char)toupper(giro.move);
+        return { giro.axis, giro.layer, -giro.direction, letra };
+    }
+
+    // eje, capa y sentido de cada movimiento; las caras B, L y D giran alrededor
+    // del eje negativo, por eso su sentido es el contrario al de F, R y U
+    LayerTurn TurnFor(STATE_ANIMATION state) const{
+        const int ultima = tamano - 1, medio = tamano / 2;
+        switch (state)
         {
-            angle = 0.0f;
-            CuboUnidad tmp_24 = cubes[24], tmp_25 = cubes[25], tmp_26 = cubes[26];
-            CuboUnidad tmp_21 = cubes[21], tmp_23 = cubes[23];
-            CuboUnidad tmp_18 = cubes[18], tmp_19 = cubes[19], tmp_20 = cubes[20];
-            cubes[24] = tmp_18, cubes[25] = tmp_21, cubes[26] = tmp_24;
-            cubes[21] = tmp_19, cubes[23] = tmp_25;
-            cubes[18] = tmp_20, cubes[19] = tmp_23, cubes[20] = tmp_26;
-            return true;
+            case STATE_ANIMATION::F: return { 2, ultima, -1, 'F' };
+            case STATE_ANIMATION::f: return { 2, ultima, 1, 'f' };
+            case STATE_ANIMATION::B: return { 2, 0, 1, 'B' };
+            case STATE_ANIMATION::b: return { 2, 0, -1, 'b' };
+            case STATE_ANIMATION::R: return { 0, ultima, -1, 'R' };
+            case STATE_ANIMATION::r: return { 0, ultima, 1, 'r' };
+            case STATE_ANIMATION::L: return { 0, 0, 1, 'L' };
+            case STATE_ANIMATION::l: return { 0, 0, -1, 'l' };
+            case STATE_ANIMATION::U: return { 1, ultima, -1, 'U' };
+            case STATE_ANIMATION::u: return { 1, ultima, 1, 'u' };
+            case STATE_ANIMATION::D: return { 1, 0, 1, 'D' };
+            case STATE_ANIMATION::d: return { 1, 0, -1, 'd' };
+            // capas centrales: M sigue a L, E sigue a D y S sigue a F (en los tamaños pares,
+            // la siguiente al medio)
+            case STATE_ANIMATION::M: return { 0, medio, 1, '\0' };
+            case STATE_ANIMATION::m: return { 0, medio, -1, '\0' };
+            case STATE_ANIMATION::E: return { 1, medio, 1, '\0' };
+            case STATE_ANIMATION::e: return { 1, medio, -1, '\0' };
+            case STATE_ANIMATION::S: return { 2, medio, -1, '\0' };
+            case STATE_ANIMATION::s: return { 2, medio, 1, '\0' };
+            // rotaciones del cubo completo: X sigue a R, Y sigue a U y Z sigue a F
+            case STATE_ANIMATION::X: return { 0, LAYER_ALL, -1, '\0' };
+            case STATE_ANIMATION::x: return { 0, LAYER_ALL, 1, '\0' };
+            case STATE_ANIMATION::Y: return { 1, LAYER_ALL, -1, '\0' };
+            case STATE_ANIMATION::y: return { 1, LAYER_ALL, 1, '\0' };
+            case STATE_ANIMATION::Z: return { 2, LAYER_ALL, -1, '\0' };
+            case STATE_ANIMATION::z: return { 2, LAYER_ALL, 1, '\0' };
+            case STATE_ANIMATION::GIRO: return giroPendiente;
+            default: return { 0, 0, 0, '\0' };
         }
-        return false;
     }
-    //// rota el DOWN del cubo en sentido antihorario
-    bool d(){
-        static float angle = 0.0f;
-        float velocidad = 0.5f;
-        angle += velocidad;
-        glm::vec3 y = glm::vec3(0.0f, -1.0f, 0.0f); // y negativo
-        glm::mat4 I4(1.0f);
-        cubes[24].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[24].model;
-        cubes[25].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[25].model;
-        cubes[26].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[26].model;
-        cubes[21].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[21].model;
-        cubes[22].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[22].model;
-        cubes[23].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[23].model;
-        cubes[18].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[18].model;
-        cubes[19].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[19].model;
-        cubes[20].model = glm::rotate(I4, glm::radians(velocidad), y) * cubes[20].model;
-        if (angle >= 90)
+
+    //// gira una capa (o el cubo completo) según la tabla de índices precalculada
+    bool RotateLayer(const LayerTurn& giro){
+        giroActivo = giro;
+        if (!turnClock.Advance())
         {
-            angle = 0.0f;
-            CuboUnidad tmp_24 = cubes[24], tmp_25 = cubes[25], tmp_26 = cubes[26];
-            CuboUnidad tmp_21 = cubes[21], tmp_23 = cubes[23];
-            CuboUnidad tmp_18 = cubes[18], tmp_19 = cubes[19], tmp_20 = cubes[20];
-            cubes[24] = tmp_26, cubes[25] = tmp_23, cubes[26] = tmp_20;
-            cubes[21] = tmp_25, cubes[23] = tmp_19;
-            cubes[18] = tmp_24, cubes[19] = tmp_21, cubes[20] = tmp_18;
-            return true;
+            // el ángulo sale del progreso del giro, no se acumula frame a frame
+            anguloActivo = giro.direction * turnClock.Angle();
+            return false;
         }
-        return false;
+        anguloActivo = 0.0f;
+
+        // al terminar, cada cubo de la capa encaja en su nueva posición y orientación enteras
+        int n = estado.ApplyTurn(giro, movidos.data());
+        for (int k = 0; k < n; ++k)
+            cubes[movidos[k]].model = estado.Model(movidos[k]);
+        return true;
     }
 };
 // END RUBIK CUBE
@@ -992,10 +777,46 @@ public:
 
 // rubik cube
 CuboCompleto::STATE_ANIMATION animation_state = CuboCompleto::STATE_ANIMATION::NONE;
+CuboCompleto* cuboActivo = nullptr; // cubo que controla key_callback
+Profiler perfil; // tiempos por sección del render loop
+bool mostrarHud = false; // estadísticas de tiempo en el título de la ventana
+FrameRecorder grabadora; // capturas (F12) y grabaciones (V) de la ventana en PNG
+int capturas = 0; // numera captura_NNN.png
+int grabaciones = 0; // numera grabacion_NNN_*.png
 bool flagCambioCamara = 0;
 
-int main()
+// opciones del modo sin ventana: renderiza la solución de una mezcla a imágenes o video crudo
+struct OpcionesHeadless
 {
+    bool activo = false;
+    int ancho = SCR_WIDTH;
+    int alto = SCR_HEIGHT;
+    int fps = 30;
+    int frames = 0; // 0: hasta terminar la solución y un segundo más
+    int mezcla = 25; // giros al azar antes de resolver
+    unsigned semilla = 1;
+    float giros = 2.0f; // giros por segundo
+    FrameWriter::FORMAT formato = FrameWriter::FORMAT::PPM;
+    std::string salida = "frame";
+    bool stickers = false; // stickers procedurales en vez de la textura
+    int benchmark = 0; // frames por modo de dibujo a medir; 0 graba la solución
+    int grilla = 1; // el benchmark dibuja grilla x grilla cubos
+    char metodo = 'B'; // método del solver, como CuboCompleto::metodo
+    int tamano = 3; // cubos por arista, como CuboCompleto::tamano; también vale con ventana
+};
+bool LeerOpciones(int argc, char** argv, OpcionesHeadless& opciones);
+int RenderHeadless(const OpcionesHeadless& opciones);
+bool GrabarSolucion(CuboCompleto& rubik, RenderTarget& destino, const OpcionesHeadless& opciones);
+bool MedirModos(CuboCompleto& rubik, RenderTarget& destino, const OpcionesHeadless& opciones);
+
+int main(int argc, char** argv)
+{
+    OpcionesHeadless opciones;
+    if (!LeerOpciones(argc, argv, opciones))
+        return 1;
+    if (opciones.activo)
+        return RenderHeadless(opciones);
+
     // glfw: initialize and configure
     // ------------------------------
     glfwInit();
@@ -1012,7 +833,7 @@ int main()
     GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "Rubik CuboUnidad", NULL, NULL);
     if (window == NULL)
     {
-        std::cout << "Failed to create GLFW window" << std::endl;
+        LOG_ERROR("Failed to create GLFW window");
         glfwTerminate();
         return -1;
     }
@@ -1031,7 +852,7 @@ int main()
     // ---------------------------------------
     if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
     {
-        std::cerr << "Failed to initialize GLAD" << std::endl;
+        LOG_ERROR("Failed to initialize GLAD");
         return -1;
     }
 
@@ -1042,30 +863,19 @@ int main()
     // build and compile our shader zprogram
     // ------------------------------------
     GLuint VBO[1], VAO[1], EBO[1];
-    glGenVertexArrays(1, VAO);
-    glGenBuffers(1, VBO);
-    glGenBuffers(1, EBO);
-
-    glBindVertexArray(VAO[0]);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO[0]);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO[0]);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-    // textures attributes
-    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(GLfloat)));
-    glEnableVertexAttribArray(1);
-    // wire mode color attribute
+    CrearGeometria(VAO[0], VBO[0], EBO[0]);
 
     CuboCompleto rubik(
             "shaders/vertexShader.shader",
             "shaders/fragmentShader.shader",
-            "assets/CuboRubik.png"
+            "assets/CuboRubik.png",
+            opciones.tamano
     );
     //asociamos el VAO correspondiente
     rubik.AssociateVAO(VAO[0]);
+    rubik.LoadStickerShaders("shaders/stickerVertex.shader", "shaders/stickerFragment.shader");
+    rubik.LoadMeshShaders("shaders/meshVertex.shader", "shaders/meshFragment.shader");
+    cuboActivo = &rubik;
 
     solver::Rubik myrubik;
 
@@ -1082,8 +892,14 @@ int main()
     glLineWidth(10.0f);
     // render loop
     // -----------
+    int progresoMostrado = -1; // porcentaje del solver que muestra el título, -1 si no hay
+    std::string hud; // estadísticas de tiempo que muestra el título
+    double siguienteHud = 0.0;
+    GpuTimer tiempoGpu;
+    tiempoGpu.Init(perfil, "gpu:DrawCube");
     while (!glfwWindowShouldClose(window))
     {
+        perfil.BeginFrame();
         // per-frame time logic
         // --------------------
         float currentFrame = glfwGetTime();
@@ -1106,7 +922,6 @@ int main()
         float cam2 = cos(glfwGetTime()) * radius;
 //        std::cout << "al: " << glfwGetTime() << std::endl;
         if(aleatorio%13==0){
-            std::cout<<"2"<<std::endl;
             camX = cam1;
             camY = 0.0f;
             camZ = cam2;
@@ -1114,7 +929,6 @@ int main()
             dirY = 1.0f;
         }
         else if(aleatorio%11==0){
-            std::cout<<"3"<<std::endl;
             camX = cam1;
             camY = cam2;
             camZ = 0.0f;
@@ -1122,7 +936,6 @@ int main()
             dirZ = 1.0f;
         }
         else if(aleatorio%7==0){
-            std::cout<<"3"<<std::endl;
             camX = 0.0f;
             camY = cam1;
             camZ = cam2;
@@ -1130,7 +943,6 @@ int main()
             dirX = 1.0f;
         }
         else if(aleatorio%5==0){
-            std::cout<<"3"<<std::endl;
             camX = cam1;
             camY = cam1;
             camZ = cam2;
@@ -1138,7 +950,6 @@ int main()
             dirX = 1.0f;
         }
         else if(aleatorio%3==0){
-            std::cout<<"3"<<std::endl;
             camX = cam2;
             camY = cam1;
             camZ = cam2;
@@ -1146,7 +957,6 @@ int main()
             dirZ = 1.0f;
         }
         else{
-            std::cout<<"else"<<std::endl;
             camX = cam2;
             camY = cam2;
             camZ = cam1;
@@ -1156,11 +966,10 @@ int main()
         // activate shader
         rubik.program.use();
         velocidad+=0.003f;
-        std::cout << "vel: " << velocidad << std::endl;
         // camera/view transformation
         if (velocidad>=1.0f) {
             aleatorio = int(glfwGetTime());
-            std::cout << "all:: " << aleatorio << std::endl;
+            LOG_DEBUG("cambio de camara: " << aleatorio);
             velocidad = 0.0f;
         }
         view = glm::lookAt(
@@ -1180,25 +989,74 @@ int main()
 
         // dibujamos el cubo de rubik
         if (animation_state == CuboCompleto::STATE_ANIMATION::SOLVE) {
+            ProfileScope medicion(perfil, "solve");
             rubik.Solve(animation_state);
         }
-        rubik.HandleDrawing(
-                view,
-                projection,
-                animation_state
-        );
+        // mientras el solver trabaja, su avance se muestra en el título de la ventana,
+        // y con el HUD activo también los tiempos del frame (se refrescan cada medio segundo)
+        int progreso = animation_state == CuboCompleto::STATE_ANIMATION::SOLVE ?
+                (int)(rubik.solveJob.Progress() * 100.0f) : -1;
+        bool cambioTitulo = progreso != progresoMostrado;
+        if (mostrarHud && perfil.Now() >= siguienteHud) {
+            hud = TextoHud(perfil);
+            siguienteHud = perfil.Now() + 0.5;
+            cambioTitulo = true;
+        }
+        else if (!mostrarHud && !hud.empty()) {
+            hud.clear();
+            cambioTitulo = true;
+        }
+        if (cambioTitulo) {
+            std::string titulo = "Rubik CuboUnidad";
+            if (progreso >= 0)
+                titulo += " - resolviendo " + std::to_string(progreso) + "%";
+            if (!hud.empty())
+                titulo += " | " + hud;
+            glfwSetWindowTitle(window, titulo.c_str());
+            progresoMostrado = progreso;
+        }
+        {
+            ProfileScope medicion(perfil, "animation");
+            rubik.Update(animation_state, deltaTime);
+        }
+        {
+            ProfileScope medicion(perfil, "DrawCube");
+            tiempoGpu.Begin();
+            rubik.Draw(view, projection);
+            tiempoGpu.End();
+        }
+        {
+            // la lectura es asíncrona: aquí solo se encola, el PNG se comprime en otro hilo
+            ProfileScope medicion(perfil, "capture");
+            int anchoBuffer, altoBuffer;
+            glfwGetFramebufferSize(window, &anchoBuffer, &altoBuffer);
+            grabadora.Frame(anchoBuffer, altoBuffer);
+        }
 
         // glfw: swap buffers and poll IO events (keys pressed/released, mouse moved etc.)
         // -------------------------------------------------------------------------------
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+        {
+            ProfileScope medicion(perfil, "swap");
+            glfwSwapBuffers(window);
+        }
+        {
+            ProfileScope medicion(perfil, "input");
+            glfwPollEvents();
+        }
+        perfil.EndFrame();
     }
+    tiempoGpu.Release();
+    grabadora.Shutdown();
+    if (grabadora.Encoder().Dropped() > 0)
+        LOG_WARN("Recording dropped " << grabadora.Encoder().Dropped() << " frames, the PNG encoder fell behind");
 
     // optional: de-allocate all resources once they've outlived their purpose:
     // ------------------------------------------------------------------------
     glDeleteVertexArrays(1, VAO);
     glDeleteBuffers(1, VBO);
     glDeleteBuffers(1, EBO);
+    rubik.ReleaseMesh();
+    texturas.Clear();
 
     // glfw: terminate, clearing all previously allocated GLFW resources.
     // ------------------------------------------------------------------
@@ -1206,6 +1064,317 @@ int main()
     return 0;
 }
 
+// VAO con los vértices y los índices de un cubo unidad (caras y contornos)
+void CrearGeometria(GLuint& VAO, GLuint& VBO, GLuint& EBO)
+{
+    glGenVertexArrays(1, &VAO);
+    glGenBuffers(1, &VBO);
+    glGenBuffers(1, &EBO);
+
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // position attribute
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+    // textures attributes
+    glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(float), (void*)(3 * sizeof(GLfloat)));
+    glEnableVertexAttribArray(1);
+}
+
+bool LeerOpciones(int argc, char** argv, OpcionesHeadless& opciones)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string opcion = argv[i];
+        if (opcion == "--headless") {
+            opciones.activo = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            fprintf(stderr, "Falta el valor de %s\n", opcion.c_str());
+            return false;
+        }
+        std::string valor = argv[++i];
+        bool valido = true;
+        if (opcion == "--size")
+            valido = sscanf(valor.c_str(), "%dx%d", &opciones.ancho, &opciones.alto) == 2 &&
+                     opciones.ancho > 0 && opciones.alto > 0;
+        else if (opcion == "--fps")
+            valido = (opciones.fps = atoi(valor.c_str())) > 0;
+        else if (opcion == "--frames")
+            valido = (opciones.frames = atoi(valor.c_str())) >= 0;
+        else if (opcion == "--scramble")
+            valido = (opciones.mezcla = atoi(valor.c_str())) >= 0;
+        else if (opcion == "--seed")
+            opciones.semilla = (unsigned)strtoul(valor.c_str(), nullptr, 10);
+        else if (opcion == "--speed")
+            valido = (opciones.giros = (float)atof(valor.c_str())) > 0.0f;
+        else if (opcion == "--format" && (valor == "ppm" || valor == "png" || valor == "raw"))
+            opciones.formato = valor == "ppm" ? FrameWriter::FORMAT::PPM :
+                               valor == "png" ? FrameWriter::FORMAT::PNG : FrameWriter::FORMAT::RAW;
+        else if (opcion == "--out")
+            opciones.salida = valor;
+        else if (opcion == "--stickers" && (valor == "textura" || valor == "procedural"))
+            opciones.stickers = valor == "procedural";
+        else if (opcion == "--benchmark")
+            valido = (opciones.benchmark = atoi(valor.c_str())) > 0;
+        else if (opcion == "--grid")
+            valido = (opciones.grilla = atoi(valor.c_str())) > 0;
+        else if (opcion == "--method" && (valor == "principiante" || valor == "cfop" || valor == "busqueda"))
+            opciones.metodo = valor == "cfop" ? 'C' : (valor == "busqueda" ? 'S' : 'B');
+        else if (opcion == "--cube")
+            valido = (opciones.tamano = atoi(valor.c_str())) >= solver::CubeN::MIN_SIZE &&
+                     opciones.tamano <= solver::CubeN::MAX_SIZE;
+        else
+            valido = false;
+        if (!valido) {
+            fprintf(stderr,
+                    "Opcion no valida: %s %s\n"
+                    "uso: final [--headless] [--size ANCHOxALTO] [--fps N] [--frames N] [--scramble N]\n"
+                    "            [--seed N] [--speed GIROS_POR_SEGUNDO] [--format ppm|png|raw] [--out RUTA]\n"
+                    "            [--stickers textura|procedural] [--benchmark FRAMES] [--grid N]\n"
+                    "            [--method principiante|cfop|busqueda] [--cube 2-7]\n",
+                    opcion.c_str(), valor.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+// renderiza sin ventana ni servidor gráfico: mezcla el cubo, lo resuelve y graba la
+// reproducción de la solución cuadro a cuadro con un paso de tiempo fijo
+int RenderHeadless(const OpcionesHeadless& opciones)
+{
+#ifdef RUBIK_HAVE_EGL
+    OffscreenContext contexto;
+    if (!contexto.Create())
+    {
+        LOG_ERROR("Failed to create EGL offscreen context (error 0x" << std::hex << eglGetError() << ")");
+        return -1;
+    }
+    if (!gladLoadGLLoader((GLADloadproc)OffscreenContext::GetProcAddress))
+    {
+        LOG_ERROR("Failed to initialize GLAD");
+        return -1;
+    }
+    LOG_INFO("Headless renderer: " << glGetString(GL_RENDERER));
+
+    RenderTarget destino;
+    if (!destino.Create(opciones.ancho, opciones.alto))
+    {
+        LOG_ERROR("Incomplete framebuffer " << opciones.ancho << "x" << opciones.alto);
+        return -1;
+    }
+    destino.Bind();
+    glEnable(GL_DEPTH_TEST);
+    GLuint VAO, VBO, EBO;
+    CrearGeometria(VAO, VBO, EBO);
+
+    CuboCompleto rubik(
+            "shaders/vertexShader.shader",
+            "shaders/fragmentShader.shader",
+            "assets/CuboRubik.png",
+            opciones.tamano
+    );
+    rubik.AssociateVAO(VAO);
+    rubik.LoadStickerShaders("shaders/stickerVertex.shader", "shaders/stickerFragment.shader");
+    rubik.LoadMeshShaders("shaders/meshVertex.shader", "shaders/meshFragment.shader");
+    if (opciones.stickers)
+        rubik.modoDibujo = CuboCompleto::MODO_DIBUJO::STICKERS;
+    rubik.turnClock.TurnsPerSecond = opciones.giros;
+    rubik.metodo = opciones.metodo;
+    rubik.Scramble(opciones.mezcla, opciones.semilla);
+
+    glLineWidth(10.0f); // lo usa el modo de referencia del benchmark
+    bool ok = opciones.benchmark > 0 ? MedirModos(rubik, destino, opciones) : GrabarSolucion(rubik, destino, opciones);
+
+    destino.Release();
+    glDeleteVertexArrays(1, &VAO);
+    glDeleteBuffers(1, &VBO);
+    glDeleteBuffers(1, &EBO);
+    rubik.ReleaseMesh();
+    texturas.Clear();
+    contexto.Destroy();
+    return ok ? 0 : -1;
+#else
+    LOG_ERROR("Headless mode needs EGL, this build was configured without it");
+    return -1;
+#endif
+}
+
+// reproduce la solución de una mezcla a velocidad fija y guarda cada frame
+bool GrabarSolucion(CuboCompleto& rubik, RenderTarget& destino, const OpcionesHeadless& opciones)
+{
+    // aquí no hay frames que cuidar: se espera al solver antes de empezar a grabar
+    CuboCompleto::STATE_ANIMATION estado = CuboCompleto::STATE_ANIMATION::SOLVE;
+    while (estado == CuboCompleto::STATE_ANIMATION::SOLVE)
+    {
+        rubik.Solve(estado);
+        if (estado == CuboCompleto::STATE_ANIMATION::SOLVE)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    FrameWriter escritor;
+    if (!escritor.Open(opciones.formato, opciones.salida))
+    {
+        LOG_ERROR("Could not open " << opciones.salida);
+        return false;
+    }
+    bool errorEscritura = false;
+    FrameReadback lectura;
+    lectura.Init(opciones.ancho, opciones.alto);
+    // los PNG se comprimen en otro hilo mientras se dibujan los frames siguientes;
+    // aquí no sobra ninguno, así que si el hilo se atrasa el render lo espera
+    FrameEncoder codificador;
+    FrameReadback::Sink guardar = [&](CapturedFrame& frame) {
+        if (opciones.formato == FrameWriter::FORMAT::PNG)
+            codificador.Push(frame, escritor.PathFor(frame.index), true);
+        else if (!errorEscritura && !escritor.Write(frame)) {
+            LOG_ERROR("Could not write frame " << frame.index << " to " << opciones.salida);
+            errorEscritura = true;
+        }
+    };
+
+    const float paso = 1.0f / opciones.fps;
+    glm::mat4 projection = glm::perspective(glm::radians(fov), (float)opciones.ancho / (float)opciones.alto, 0.1f, 100.0f);
+    int restantes = opciones.fps; // frames que se graban después de la solución
+    for (int frame = 0; opciones.frames == 0 || frame < opciones.frames; ++frame)
+    {
+        if (opciones.frames == 0 && !rubik.playback.HasNext() && estado == CuboCompleto::STATE_ANIMATION::NONE
+            && restantes-- <= 0)
+            break;
+        rubik.Update(estado, paso);
+
+        // la cámara gira despacio alrededor del cubo
+        float t = frame * paso * 0.25f;
+        glm::mat4 view = glm::lookAt(
+                glm::vec3(sin(t) * 10.0f, 5.0f, cos(t) * 10.0f),
+                glm::vec3(0.0f, 0.0f, 0.0f),
+                glm::vec3(0.0f, 1.0f, 0.0f)
+        );
+        destino.Bind();
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        rubik.Draw(view, projection);
+
+        lectura.Capture(guardar);
+        lectura.Collect(guardar);
+        if (errorEscritura)
+            break;
+    }
+    lectura.Flush(guardar);
+    codificador.Drain();
+    if (codificador.Failed() > 0) {
+        LOG_ERROR("Could not write " << codificador.Failed() << " frames to " << opciones.salida);
+        errorEscritura = true;
+    }
+    LOG_INFO("Headless render wrote " << lectura.Captured() << " frames");
+
+    escritor.Close();
+    lectura.Release();
+    return !errorEscritura;
+}
+
+// dibuja el mismo cubo mezclado con cada modo de dibujo y escribe en la salida estándar las
+// llamadas de dibujo por frame y los tiempos: cpu es lo que tarda emitir las llamadas,
+// frame incluye esperar a la GPU (glFinish) y gpu es el GL_TIME_ELAPSED del dibujo (con
+// llvmpipe no sirve: solo mide el envío de los comandos, el render se ve en frame)
+bool MedirModos(CuboCompleto& rubik, RenderTarget& destino, const OpcionesHeadless& opciones)
+{
+    const int CALENTAMIENTO = 10; // frames sin medir al cambiar de modo
+    const int MODOS = 4;
+    const CuboCompleto::MODO_DIBUJO modos[MODOS] = { CuboCompleto::MODO_DIBUJO::LINEAS,
+                                                     CuboCompleto::MODO_DIBUJO::CONTORNO,
+                                                     CuboCompleto::MODO_DIBUJO::STICKERS,
+                                                     CuboCompleto::MODO_DIBUJO::MALLA };
+    const char* nombres[MODOS] = { "lineas", "contorno", "stickers", "malla" };
+    const float SEPARACION = 4.0f; // entre los cubos de la grilla
+
+    Profiler medidas;
+    const int seccionCpu = medidas.Section("cpu");
+    const int seccionFrame = medidas.Section("frame");
+    const int seccionGpu = medidas.Section("gpu");
+    GLuint consulta;
+    glGenQueries(1, &consulta);
+    glm::mat4 projection = glm::perspective(glm::radians(fov), (float)opciones.ancho / (float)opciones.alto, 0.1f, 100.0f);
+    rubik.Publish();
+
+    printf("%dx%d, %d frames por modo, grilla de %dx%d cubos (%s)\n", opciones.ancho, opciones.alto,
+           opciones.benchmark, opciones.grilla, opciones.grilla, (const char*)glGetString(GL_RENDERER));
+    printf("%-10s %7s %9s %7s %10s %10s %10s %10s\n", "modo", "culling", "llamadas", "fuera", "cpu ms", "frame ms",
+           "frame p95", "gpu ms");
+    for (int m = 0; m < MODOS; ++m)
+    {
+        rubik.modoDibujo = modos[m];
+        for (int conCulling = 0; conCulling < 2; ++conCulling)
+        {
+            rubik.culling = conCulling == 1;
+            medidas.ResetStats();
+            long llamadas = 0, fuera = 0;
+            for (int frame = -CALENTAMIENTO; frame < opciones.benchmark; ++frame)
+            {
+                // la cámara gira alrededor del centro de la grilla: parte de los cubos queda detrás
+                float t = frame * 0.01f;
+                glm::mat4 camara = glm::lookAt(
+                        glm::vec3(sin(t) * 10.0f, 5.0f, cos(t) * 10.0f),
+                        glm::vec3(0.0f, 0.0f, 0.0f),
+                        glm::vec3(0.0f, 1.0f, 0.0f)
+                );
+                double inicio = medidas.Now();
+                destino.Bind();
+                glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+                glBeginQuery(GL_TIME_ELAPSED, consulta);
+                long llamadasAntes = rubik.llamadasDibujo, fueraAntes = rubik.cubosDescartados;
+                for (int fila = 0; fila < opciones.grilla; ++fila)
+                    for (int columna = 0; columna < opciones.grilla; ++columna)
+                    {
+                        glm::vec3 lugar((columna - (opciones.grilla - 1) * 0.5f) * SEPARACION, 0.0f,
+                                        (fila - (opciones.grilla - 1) * 0.5f) * SEPARACION);
+                        glm::mat4 view = camara * glm::translate(glm::mat4(1.0f), lugar);
+                        rubik.Draw(view, projection);
+                    }
+                double emitido = medidas.Now();
+                glEndQuery(GL_TIME_ELAPSED);
+                glFinish();
+                double fin = medidas.Now();
+                GLuint64 nanosegundos = 0;
+                glGetQueryObjectui64v(consulta, GL_QUERY_RESULT, &nanosegundos);
+                if (frame < 0)
+                    continue;
+                llamadas += rubik.llamadasDibujo - llamadasAntes;
+                fuera += rubik.cubosDescartados - fueraAntes;
+                medidas.Record(seccionCpu, inicio, emitido - inicio);
+                medidas.Record(seccionFrame, inicio, fin - inicio);
+                medidas.Record(seccionGpu, inicio, nanosegundos * 1e-9);
+            }
+            Profiler::Stats cpu = medidas.Get(seccionCpu);
+            Profiler::Stats total = medidas.Get(seccionFrame);
+            Profiler::Stats gpu = medidas.Get(seccionGpu);
+            printf("%-10s %7s %9ld %7ld %10.3f %10.3f %10.3f %10.3f\n", nombres[m], conCulling ? "si" : "no",
+                   llamadas / opciones.benchmark, fuera / opciones.benchmark, cpu.mean, total.mean, total.p95,
+                   gpu.mean);
+        }
+    }
+    rubik.culling = true;
+    glDeleteQueries(1, &consulta);
+    return true;
+}
+
+// fps y percentiles del frame y del dibujo en GPU para el título de la ventana
+std::string TextoHud(Profiler& profiler)
+{
+    Profiler::Stats frame = profiler.Get(profiler.Section("frame"));
+    Profiler::Stats gpu = profiler.Get(profiler.Section("gpu:DrawCube"));
+    char texto[160];
+    snprintf(texto, sizeof(texto), "%.0f fps | frame p50 %.1f p95 %.1f p99 %.1f ms | gpu p95 %.2f ms",
+             frame.mean > 0.0 ? 1000.0 / frame.mean : 0.0, frame.p50, frame.p95, frame.p99, gpu.p95);
+    return texto;
+}
+
 // process all input: query GLFW whether relevant keys are pressed/released this frame and react accordingly
 // ---------------------------------------------------------------------------------------------------------
 void processInput(GLFWwindow* window, bool flagCambioCamara)
@@ -1229,7 +1398,83 @@ void processInput(GLFWwindow* window, bool flagCambioCamara)
 
 void key_callback(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
-    if (animation_state == CuboCompleto::STATE_ANIMATION::NONE) {
+    // velocidad de los giros, se puede cambiar incluso durante una animación
+    if (key == GLFW_KEY_EQUAL && action == GLFW_PRESS)
+        cuboActivo->turnClock.SpeedUp();
+    if (key == GLFW_KEY_MINUS && action == GLFW_PRESS)
+        cuboActivo->turnClock.SlowDown();
+
+    // reproducción de la solución: pausa, paso a paso y saltos
+    if (key == GLFW_KEY_SPACE && action == GLFW_PRESS)
+        cuboActivo->TogglePlay();
+    if (key == GLFW_KEY_RIGHT && action == GLFW_PRESS) {
+        if (mods & GLFW_MOD_SHIFT)
+            cuboActivo->Seek((long)cuboActivo->playback.Cursor() + 10, animation_state);
+        else
+            cuboActivo->StepForward(animation_state);
+    }
+    if (key == GLFW_KEY_LEFT && action == GLFW_PRESS) {
+        if (mods & GLFW_MOD_SHIFT)
+            cuboActivo->Seek((long)cuboActivo->playback.Cursor() - 10, animation_state);
+        else
+            cuboActivo->StepBack(animation_state);
+    }
+    // medición: H muestra los tiempos en el título, P empieza/termina una captura para chrome://tracing
+    if (key == GLFW_KEY_H && action == GLFW_PRESS)
+        mostrarHud = !mostrarHud;
+    if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+        if (!perfil.Tracing()) {
+            perfil.ResetStats();
+            perfil.StartTrace();
+            LOG_INFO("Profiler capture started");
+        }
+        else {
+            if (perfil.StopTrace("perfil_trace.json"))
+                LOG_INFO("Profiler capture written to perfil_trace.json\n" << perfil.Summary());
+            else
+                LOG_ERROR("Could not write perfil_trace.json");
+        }
+    }
+
+    // F12 guarda el frame actual, V empieza/termina una grabación cuadro a cuadro
+    if (key == GLFW_KEY_F12 && action == GLFW_PRESS) {
+        char nombre[32];
+        std::snprintf(nombre, sizeof(nombre), "captura_%03d.png", capturas++);
+        grabadora.Screenshot(nombre);
+        LOG_INFO("Saving screenshot to " << nombre);
+    }
+    if (key == GLFW_KEY_V && action == GLFW_PRESS) {
+        if (!grabadora.Recording()) {
+            char prefijo[32];
+            std::snprintf(prefijo, sizeof(prefijo), "grabacion_%03d", grabaciones++);
+            grabadora.StartRecording(prefijo);
+            LOG_INFO("Recording to " << prefijo << "_*.png");
+        }
+        else {
+            grabadora.StopRecording();
+            LOG_INFO("Recording stopped");
+        }
+    }
+
+    // T cambia el modo de dibujo: contorno en el shader, stickers procedurales, líneas
+    if (key == GLFW_KEY_T && action == GLFW_PRESS)
+        cuboActivo->NextDrawMode();
+
+    // M cambia el método del solver para la próxima vez que se pida la solución
+    if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+        cuboActivo->metodo = cuboActivo->metodo == 'B' ? 'C' : (cuboActivo->metodo == 'C' ? 'S' : 'B');
+        LOG_INFO("Solver method: " << NombreMetodo(cuboActivo->metodo));
+    }
+
+    // cancela el solver si todavía está buscando la solución
+    if (key == GLFW_KEY_BACKSPACE && action == GLFW_PRESS)
+        cuboActivo->CancelSolve(animation_state);
+    if (key == GLFW_KEY_HOME && action == GLFW_PRESS)
+        cuboActivo->Seek(0, animation_state);
+    if (key == GLFW_KEY_END && action == GLFW_PRESS)
+        cuboActivo->Seek((long)cuboActivo->playback.Size(), animation_state);
+
+    if (animation_state == CuboCompleto::STATE_ANIMATION::NONE && !cuboActivo->playback.Playing) {
         if (key == GLFW_KEY_F && action == GLFW_PRESS)
             animation_state = CuboCompleto::STATE_ANIMATION::F;
         if (key == GLFW_KEY_R && action == GLFW_PRESS)
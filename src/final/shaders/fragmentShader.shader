@@ -2,12 +2,39 @@
 out vec4 FragColor;
 
 in vec2 TexCoord;
+in vec3 LocalPos;
 
 // texture samplers
 uniform sampler2D texture1;
-uniform vec4 ourColorGlobal;
+// UP, LEFT, FRONT, RIGHT, BACK, DOWN; inner faces are black
+uniform vec4 faceColors[6];
+// width of the black outline along the border of each face, in cube units (the side is 1);
+// 0 draws no outline and 0.5 or more paints the whole face black
+uniform float outlineWidth;
 
 void main()
 {
-    FragColor = texture(texture1, TexCoord) * ourColorGlobal;
+	// the face is the axis where the point touches the cube, the other two are its uv
+	vec3 p = abs(LocalPos);
+	int face;
+	vec2 uv;
+	if (p.y >= p.x && p.y >= p.z) {
+		face = LocalPos.y > 0.0 ? 0 : 5;
+		uv = LocalPos.xz;
+	}
+	else if (p.x >= p.z) {
+		face = LocalPos.x < 0.0 ? 1 : 3;
+		uv = LocalPos.yz;
+	}
+	else {
+		face = LocalPos.z > 0.0 ? 2 : 4;
+		uv = LocalPos.xy;
+	}
+	vec4 color = texture(texture1, TexCoord) * faceColors[face];
+
+	// distance to the nearest edge of the face, antialiased over one pixel
+	float edge = 0.5 - max(abs(uv.x), abs(uv.y));
+	float w = fwidth(edge);
+	float inside = outlineWidth > 0.0 ? smoothstep(outlineWidth - w, outlineWidth + w, edge) : 1.0;
+	FragColor = mix(vec4(0.0, 0.0, 0.0, 1.0), color, inside);
 }
\ No newline at end of file
@@ -0,0 +1,23 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+in vec3 LocalPos;
+in vec3 Color;
+
+// texture samplers
+uniform sampler2D texture1;
+// width of the black outline along the border of each face, in cube units (the side is 1)
+uniform float outlineWidth;
+
+void main()
+{
+	// distance to the nearest edge of the face: the two coordinates that are not on the
+	// face normal (the largest one) are its uv
+	vec3 p = abs(LocalPos);
+	vec2 uv = p.y >= p.x && p.y >= p.z ? p.xz : (p.x >= p.z ? p.yz : p.xy);
+	float edge = 0.5 - max(uv.x, uv.y);
+	float w = fwidth(edge);
+	float inside = outlineWidth > 0.0 ? smoothstep(outlineWidth - w, outlineWidth + w, edge) : 1.0;
+	FragColor = mix(vec4(0.0, 0.0, 0.0, 1.0), texture(texture1, TexCoord) * vec4(Color, 1.0), inside);
+}
\ No newline at end of file
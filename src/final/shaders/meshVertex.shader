@@ -0,0 +1,27 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aTexCoord;
+layout (location = 2) in vec3 aColor;
+layout (location = 3) in int aCubie;
+
+out vec2 TexCoord;
+out vec3 LocalPos;
+out vec3 Color;
+
+// transform of every cubie (turn and global transform included), updated once per frame
+layout (std140) uniform Cubies
+{
+	mat4 models[218]; // PuzzleMeshRenderer::MAX_CUBIES
+};
+uniform mat4 view;
+uniform mat4 projection;
+// the sticker colours pulse with time
+uniform float brightness;
+
+void main()
+{
+	gl_Position = projection * view * models[aCubie] * vec4(aPos, 1.0f);
+	TexCoord = aTexCoord;
+	LocalPos = aPos;
+	Color = aColor * brightness;
+}
\ No newline at end of file
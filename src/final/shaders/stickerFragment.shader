@@ -0,0 +1,38 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec3 LocalPos;
+
+// UP, LEFT, FRONT, RIGHT, BACK, DOWN; inner faces are black
+uniform vec4 faceColors[6];
+// half side of the coloured sticker and radius of its corners (the cube side is 1),
+// the rest of the face is the black plastic that the line loops used to draw
+uniform float stickerHalf = 0.44;
+uniform float cornerRadius = 0.08;
+
+void main()
+{
+	// the face is the axis where the point touches the cube, the other two are its uv
+	vec3 p = abs(LocalPos);
+	int face;
+	vec2 uv;
+	if (p.y >= p.x && p.y >= p.z) {
+		face = LocalPos.y > 0.0 ? 0 : 5;
+		uv = LocalPos.xz;
+	}
+	else if (p.x >= p.z) {
+		face = LocalPos.x < 0.0 ? 1 : 3;
+		uv = LocalPos.yz;
+	}
+	else {
+		face = LocalPos.z > 0.0 ? 2 : 4;
+		uv = LocalPos.xy;
+	}
+
+	// signed distance to a rounded square, antialiased over one pixel
+	vec2 q = abs(uv) - vec2(stickerHalf - cornerRadius);
+	float d = length(max(q, 0.0)) + min(max(q.x, q.y), 0.0) - cornerRadius;
+	float w = fwidth(d);
+	float sticker = 1.0 - smoothstep(-w, w, d);
+	FragColor = mix(vec4(0.0, 0.0, 0.0, 1.0), faceColors[face], sticker);
+}
\ No newline at end of file
@@ -3,6 +3,7 @@ layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec2 aTexCoord;
 
 out vec2 TexCoord;
+out vec3 LocalPos;
 
 uniform mat4 model;
 uniform mat4 view;
@@ -12,4 +13,6 @@ void main()
 {
 	gl_Position = projection * view * model * vec4(aPos, 1.0f);
 	TexCoord = vec2(aTexCoord.x, aTexCoord.y);
+	// position on the unit cube, used to find the face and its border
+	LocalPos = aPos;
 }
\ No newline at end of file